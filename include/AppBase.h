@@ -16,6 +16,8 @@
 #include <string>
 #include <iostream>
 #include <stdexcept>
+#include <vector>
+#include <boost/scoped_ptr.hpp>
 
 //----------------------
 // Base Class Headers --
@@ -30,6 +32,10 @@
 //------------------------------------
 #include "AppUtils/AppCmdLine.h"
 #include "AppUtils/AppCmdOptIncr.h"
+namespace AppUtils {
+class AppFileWatcher ;
+class AppPrefetch ;
+}
 
 //
 // Convenience macro for defining main() function which "runs" given app class
@@ -111,6 +117,74 @@ protected:
    */
   virtual void moreUsage ( std::ostream& out ) const ;
 
+  /**
+   *  @brief Start watching options files for changes.
+   *
+   *  Watches all options files read when the command line was parsed (see
+   *  AppFileWatcher), typically called from preRunApp(). Changes are not
+   *  delivered asynchronously, long-running applications call checkOptionsFiles()
+   *  from their main loop, or add optionsFilesFd() to their own poll() loop and
+   *  call checkOptionsFiles() when it becomes readable.
+   *
+   *  @param[in] coalesce  Changes which follow each other within this interval
+   *                       (in seconds) are handled together.
+   *  @return false if some options files cannot be watched.
+   */
+  bool watchOptionsFiles ( double coalesce = 0.1 ) ;
+
+  /**
+   *  @brief Wait for changes in options files and apply them.
+   *
+   *  If any of the watched options files changed then new values are applied
+   *  to options (see AppCmdLine::reloadOptionsFiles()) and optionsFilesChanged()
+   *  is called with the list of updated options. Errors in the options files
+   *  are reported to the logger, options keep their values in this case. After
+   *  successful reload files which are newly included by options files are
+   *  added to the watched set.
+   *
+   *  @param[in] timeout  Maximum time to wait for changes in seconds, zero means
+   *                      no waiting, negative means to wait indefinitely.
+   *  @return Number of updated options, or -1 on errors in the options files.
+   */
+  int checkOptionsFiles ( double timeout = 0 ) ;
+
+  /**
+   *  Returns file descriptor which becomes readable when options files change,
+   *  or -1 if watching is not started or not supported.
+   */
+  int optionsFilesFd() const ;
+
+  /**
+   *  Method called by checkOptionsFiles() after new values from options files
+   *  are applied, can be overridden in subclasses. Default implementation does
+   *  nothing.
+   */
+  virtual void optionsFilesChanged ( const std::vector<AppCmdOptBase*>& options ) ;
+
+  /**
+   *  @brief Enable reading of options files and data files at startup in background.
+   *
+   *  If enabled then run() finds options files in the command line (see
+   *  AppCmdLine::optionsFilesInArgs()) and starts reading them together with
+   *  resolving data paths given to prefetchDataPath() in a separate thread
+   *  (see AppPrefetch) before the command line is parsed. File system latency
+   *  then overlaps with parsing, logger setup and preRunApp(). Typically
+   *  called from subclass constructor.
+   */
+  void enablePrefetch ( bool enable = true ) ;
+
+  /**
+   *  Add data file (path relative to $SIT_DATA) to resolve at startup if
+   *  prefetch is enabled, typically called from subclass constructor.
+   */
+  void prefetchDataPath ( const std::string& relPath ) ;
+
+  /**
+   *  Returns path of the data file, same as AppDataPath(relPath).path() but
+   *  uses result of prefetch if the path was given to prefetchDataPath().
+   */
+  std::string dataPath ( const std::string& relPath ) ;
+
   /**
    * Get the complete command line
    */
@@ -123,10 +197,15 @@ protected:
 
 private:
 
+  // add options files read by parser to watcher, returns false if some files cannot be watched
+  bool addWatchedFiles () ;
+
   // Data members
   AppCmdLine _cmdline ;
   AppCmdOptIncr _optVerbose ;
   AppCmdOptIncr _optQuiet ;
+  boost::scoped_ptr<AppFileWatcher> _watcher ;
+  boost::scoped_ptr<AppPrefetch> _prefetch ;
 
   // Copy constructor and assignment are disabled by default
   AppBase ( const AppBase& ) ;
@@ -194,6 +194,22 @@ protected:
     _changed = false ;
   }
 
+  /**
+   *  Reset value stored outside of argument to its default value.
+   */
+  virtual void resetValue( boost::any& value ) const {
+    value = _defValue ;
+  }
+
+  /**
+   *  Update value stored outside of argument.
+   *
+   *  @return The number of consumed words.
+   */
+  virtual int updateValue ( StringList::const_iterator begin,
+                            StringList::const_iterator end,
+                            boost::any& value ) const ;
+
 
 private:
 
@@ -295,6 +311,26 @@ AppCmdArg<Type>::setValue ( StringList::const_iterator begin,
   return 1 ;
 }
 
+/*
+ *  Update value stored outside of argument.
+ *
+ *  @return The number of consumed words.
+ */
+template <typename Type>
+int
+AppCmdArg<Type>::updateValue ( StringList::const_iterator begin,
+                               StringList::const_iterator end,
+                               boost::any& value ) const
+{
+  // sequence must be non-empty
+  assert ( begin != end ) ;
+
+  value = AppCmdTypeTraits<Type>::fromString ( *begin ) ;
+  // only one string could be supplied
+  assert ( ++ begin == end ) ;
+  return 1 ;
+}
+
 } // namespace AppUtils
 
 #endif  // APPUTILS_APPCMDARG_HH
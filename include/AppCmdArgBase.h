@@ -17,6 +17,7 @@
 //---------------
 #include <string>
 #include <vector>
+#include <boost/any.hpp>
 
 //----------------------
 // Base Class Headers --
@@ -132,6 +133,32 @@ protected:
    */
   virtual void reset() = 0 ;
 
+  /**
+   *  @brief Reset value stored outside of argument to its default value.
+   *
+   *  This method and updateValue() are used by parser instead of reset() and
+   *  setValue() when argument values are stored outside of argument objects,
+   *  e.g. when many command lines are parsed in parallel. They must not modify
+   *  the argument object. Default implementation throws an exception, arguments
+   *  which do not implement these methods cannot be used in such parsing mode.
+   *
+   *  @throw AppCmdException if argument does not support external storage.
+   */
+  virtual void resetValue( boost::any& value ) const ;
+
+  /**
+   *  @brief Update value stored outside of argument.
+   *
+   *  Same as setValue() but modifies value stored outside of argument object.
+   *  Type of the stored value is the same as the type of value returned from
+   *  argument's value() method.
+   *
+   *  @return The number of consumed words.
+   */
+  virtual int updateValue ( StringList::const_iterator begin,
+                            StringList::const_iterator end,
+                            boost::any& value ) const ;
+
 private:
 
   // All private methods are accessible to the parser
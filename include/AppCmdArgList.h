@@ -215,6 +215,26 @@ protected:
     _changed = false ;
   }
 
+  /**
+   *  Reset value stored outside of argument to its default value.
+   */
+  virtual void resetValue( boost::any& value ) const {
+    value = _defValue ;
+  }
+
+  /**
+   *  Update value stored outside of argument.
+   *
+   *  @return The number of consumed words.
+   */
+  virtual int updateValue ( StringList::const_iterator begin,
+                            StringList::const_iterator end,
+                            boost::any& value ) const ;
+
+  // convert all words, throws if any conversion fails
+  static container convert ( StringList::const_iterator begin,
+                             StringList::const_iterator end ) ;
+
 private:
 
   // Friends
@@ -296,6 +316,33 @@ AppCmdArgList<Type>::setValue ( StringList::const_iterator begin,
   // sequence must be non-empty
   assert ( begin != end ) ;
 
+  _value = convert ( begin, end ) ;
+  _changed = true ;
+
+  return _value.size() ;
+}
+
+//  Update value stored outside of argument.
+template <typename Type>
+int
+AppCmdArgList<Type>::updateValue ( StringList::const_iterator begin,
+                                   StringList::const_iterator end,
+                                   boost::any& value ) const
+{
+  // sequence must be non-empty
+  assert ( begin != end ) ;
+
+  value = convert ( begin, end ) ;
+
+  return boost::any_cast<const container&>(value).size() ;
+}
+
+//  Convert all words, throws if any conversion fails.
+template <typename Type>
+typename AppCmdArgList<Type>::container
+AppCmdArgList<Type>::convert ( StringList::const_iterator begin,
+                               StringList::const_iterator end )
+{
   container localCont ;
 
   for ( ; begin != end ; ++ begin ) {
@@ -304,10 +351,7 @@ AppCmdArgList<Type>::setValue ( StringList::const_iterator begin,
     localCont.push_back ( res ) ;
   }
 
-  _value = localCont ;
-  _changed = true ;
-
-  return _value.size() ;
+  return localCont ;
 }
 
 } // namespace AppUtils
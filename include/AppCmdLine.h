@@ -17,7 +17,13 @@
 //---------------
 #include <string>
 #include <vector>
+#include <map>
 #include <iosfwd>
+#include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/utility/string_ref.hpp>
+#include <boost/thread/mutex.hpp>
 
 //----------------------
 // Base Class Headers --
@@ -27,6 +33,9 @@
 //-------------------------------
 // Collaborating Class Headers --
 //-------------------------------
+#include "AppUtils/AppCmdOptFile.h"
+#include "AppUtils/AppCmdParseResult.h"
+#include "AppUtils/AppCmdParseStats.h"
 
 //------------------------------------
 // Collaborating Class Declarations --
@@ -101,6 +110,7 @@ namespace AppUtils {
  *  @see AppCmdOpt
  *  @see AppCmdOptToggle
  *  @see AppCmdOptIncr
+ *  @see AppCmdOptRangeList
  *
  *  @version $Id$
  *
@@ -138,6 +148,18 @@ public:
    */
   virtual void addGroup(AppCmdOptGroup& group);
 
+  /**
+   *  @brief Add one option to the parser.
+   *
+   *  Same as AppCmdOptGroup::addOption() but throws exception if parser was
+   *  already compiled.
+   *
+   *  @param[in] option   Option instance to add to the parser.
+   *
+   *  @throw AppCmdException if compile() was called already.
+   */
+  virtual void addOption(AppCmdOptBase& option);
+
   /**
    *  @brief Add one positional argument to parser.
    *
@@ -166,12 +188,92 @@ public:
    *  This method may throw an exception if the option name conflicts with the previously
    *  added options.
    *
+   *  Options files can include other files with the "@include path" directive,
+   *  relative paths are relative to the directory of the including file. Lines of
+   *  the included file are processed in place of the directive. Recursive includes
+   *  are errors. Each included file is read only once per parse() even if it is
+   *  included from many files.
+   *
    *  @param[in] option   Option instance to add to the parser.
    *
    *  @throw AppCmdException or a subclass of it.
    */
   virtual void setOptionsFile ( AppCmdOptList<std::string>& option ) ;
 
+  /**
+   *  @brief Enable cache for options files.
+   *
+   *  When cache directory is set every options file is saved in that directory
+   *  in a pre-split binary form after it is read, and next time the same file is
+   *  needed (by this or any other process) it is loaded from cache without
+   *  parsing its text. Cache is transparently updated when options file changes.
+   *  Empty string disables cache, this is the default.
+   *
+   *  @param[in] cacheDir   Directory for cache files, must exist and be writable.
+   *
+   *  @see AppCmdOptFile
+   */
+  void setOptionsFileCache ( const std::string& cacheDir ) ;
+
+  /**
+   *  @brief Set number of threads used to read options files.
+   *
+   *  When many options files are given they are read and split in parallel,
+   *  which hides latency of network file systems, and then applied to options
+   *  one after another in the order they were given, so the result is the same
+   *  as with sequential reading. Errors are also reported for the first failing
+   *  file in that order. By default (zero) one thread per file is used, but not
+   *  more than the number of hardware threads and not more than eight. One means
+   *  reading files sequentially in the calling thread. A single file is always
+   *  read in the calling thread, and parseBatch() reads files sequentially in
+   *  each of its worker threads.
+   *
+   *  @param[in] nThreads   Maximum number of threads, 0 for the default.
+   */
+  void setOptionsFileThreads ( unsigned nThreads ) ;
+
+  /**
+   *  @brief Enable collection of parsing statistics.
+   *
+   *  When statistics object is set every parse() call (including calls from
+   *  parseBatch() and the const parse() methods) adds its timing and counters
+   *  to it, see AppCmdParseStats for details. Each parse() collects numbers
+   *  locally and merges them into the given object at the end under a lock,
+   *  so that many threads can use the same parser. Statistics object is not
+   *  copied, it must exist while it is set in parser. Zero pointer disables
+   *  statistics, this is the default, parsing has no extra overhead then.
+   *
+   *  @param[in] stats   Object which receives statistics, or zero.
+   */
+  void setParseStats ( AppCmdParseStats* stats ) ;
+
+  /// Returns object receiving statistics or zero
+  AppCmdParseStats* parseStats() const { return _stats; }
+
+  /**
+   *  @brief Freeze and compile parser definition.
+   *
+   *  By default every call to parse() collects options from all groups, indexes
+   *  their names, checks them for conflicts and verifies the order of positional
+   *  arguments. This allows adding options and arguments between calls to parse().
+   *  Applications which parse many command lines with the same parser can instead
+   *  call compile() once after all options, groups and arguments are defined; it
+   *  does all above checks once and subsequent parse() calls only do the work
+   *  which is specific to each command line. After compile() no options, groups
+   *  or arguments can be added to the parser or to its option groups, methods
+   *  adding them throw an exception (options added directly to the groups are
+   *  detected on next call to parse()). Calling compile() more than once has no
+   *  effect.
+   *
+   *  @throw AppCmdException or a subclass of it if definitions are inconsistent.
+   */
+  void compile() ;
+
+  /**
+   *  Returns true if compile() has been called already.
+   */
+  bool compiled() const { return _compiled; }
+
   /**
    *  @brief Parse command line.
    *
@@ -212,7 +314,7 @@ public:
    *  @brief Parse command line.
    *
    *  Overloaded variant of parse() which accepts iterators. Value type for iterators
-   *  should be type convertible to std::string. Unlike two other forms of parse()
+   *  should be either const char* or type convertible to std::string. Unlike two other forms of parse()
    *  this method does not discard first element of sequence (*begin) so @c begin
    *  should point to first option or argument and not to application name. An example
    *  of its use with the @c argc and @c argv parameters passed to main():
@@ -231,6 +333,216 @@ public:
   template <typename Iter>
   void parse ( Iter begin, Iter end ) ;
 
+  /**
+   *  @brief Parse command line and store values in the result object.
+   *
+   *  Same as parse(argc, argv) but values of options and arguments are stored
+   *  in the result object and option and argument objects are not modified,
+   *  use AppCmdParseResult::value() methods to get the values. This method
+   *  does not change the parser, so the same parser can be used by many threads
+   *  simultaneously with different result objects. Parser must be compiled
+   *  (see compile()) before this method is called. All option and argument
+   *  classes in this package support this mode, user-defined options and arguments
+   *  need to implement resetValue() and updateValue() methods.
+   *
+   *  @param[in] argc     Argument counter
+   *  @param[in] argv     Argument vector
+   *  @param[out] result  Object which receives values of options and arguments.
+   *  @throw AppCmdException or any its subclass is thrown in case parsing fails
+   *         or if parser was not compiled.
+   */
+  void parse ( int argc, char* argv[], AppCmdParseResult& result ) const ;
+
+  /**
+   *  @brief Parse command line and store values in the result object.
+   *
+   *  Same as parse(argc, argv, result) with the const argument vector.
+   */
+  void parse ( int argc, const char* argv[], AppCmdParseResult& result ) const ;
+
+  /**
+   *  @brief Parse command line and store values in the result object.
+   *
+   *  Same as parse(begin, end) but values of options and arguments are stored
+   *  in the result object, see parse(argc, argv, result) for details.
+   *
+   *  @param[in] begin    Iterator pointing to first item.
+   *  @param[in] end      Iterator pointing past the last item.
+   *  @param[out] result  Object which receives values of options and arguments.
+   *  @throw AppCmdException or any its subclass is thrown in case parsing fails
+   *         or if parser was not compiled.
+   */
+  template <typename Iter>
+  void parse ( Iter begin, Iter end, AppCmdParseResult& result ) const ;
+
+  /**
+   *  @brief Convert arguments of all options with lazy conversion.
+   *
+   *  Options in lazy mode (see AppCmdOpt::setLazy()) convert their arguments
+   *  when their values are accessed first time and conversion errors appear
+   *  only at that time. Calling this method after parse() converts all such
+   *  options immediately so that all errors are reported in one place, it is
+   *  equivalent to parsing without lazy mode.
+   *
+   *  @throw AppCmdException or a subclass of it if conversion fails for any option.
+   */
+  void validate() const ;
+
+  /**
+   *  @brief Re-read options files which changed since last parse().
+   *
+   *  Applications which run for a long time may want to pick up changes in
+   *  their options files without parsing whole command line again. This method
+   *  checks modification time and size of every options file read by the last
+   *  parse() (the one which stores values in options), reads again only files
+   *  which changed and finds options whose values in options files are different
+   *  now. Only those options are reset and get new values, other options are not
+   *  touched. Like in parse(), options given on the command line are not changed.
+   *  Options which disappeared from files are reset to their default values.
+   *  Files which were only touched but have the same contents do not cause any
+   *  changes.
+   *
+   *  New values are converted before any option is modified, so if the exception
+   *  is thrown (e.g. file was removed or new value cannot be converted) then all
+   *  options keep their values and next call to this method will try to apply
+   *  the same changes again. Like with parse() into AppCmdParseResult, options
+   *  read from options files need to implement resetValue() and updateValue().
+   *
+   *  @return List of options which got new values, in the order of the parser options.
+   *
+   *  @throw AppCmdException or a subclass of it if file cannot be read or parsed.
+   */
+  std::vector<AppCmdOptBase*> reloadOptionsFiles() ;
+
+  /**
+   *  @brief Get the names of options files read by the last parse().
+   *
+   *  Only parse() methods which store values in options remember the files,
+   *  these are the files checked by reloadOptionsFiles(). Files included from
+   *  options files are in this list too, with their canonical paths.
+   */
+  std::vector<std::string> optionsFilesRead() const ;
+
+  /**
+   *  @brief Find names of options files in command line without parsing it.
+   *
+   *  Looks for the options file option (see setOptionsFile()) in the command
+   *  line and returns its arguments, nothing is parsed or changed. Other options
+   *  are not checked so the result is only a hint, an argument of other option
+   *  which looks like options file option will be reported too. It is used to
+   *  start reading of options files before parsing (see AppPrefetch).
+   *
+   *  @param[in] argc   Argument counter
+   *  @param[in] argv   Argument vector, argv[0] is ignored like in parse()
+   */
+  std::vector<std::string> optionsFilesInArgs ( int argc, const char* argv[] ) const ;
+
+  /**
+   *  @brief Enable recording of option values for saveSnapshot().
+   *
+   *  When enabled every parse() which stores values in options remembers all
+   *  values given to options together with their source (position on command
+   *  line, or options file and line number) and the positional arguments.
+   *  Every value is copied so recording is disabled by default.
+   */
+  void setRecordValues ( bool enable ) ;
+
+  /**
+   *  @brief Save resolved configuration of the last parse().
+   *
+   *  Writes all values given to options with their sources, names of options
+   *  which kept default values, and positional arguments. Format is line-oriented
+   *  text, strings are prefixed with their length so values may contain any
+   *  characters. loadSnapshot() restores exactly the same configuration without
+   *  reading command line or options files, e.g. to restart failed job.
+   *
+   *  @throw AppCmdException if values were not recorded (see setRecordValues()) or writing fails.
+   */
+  void saveSnapshot ( std::ostream& out ) const ;
+
+  /**
+   *  @brief Set options and arguments from the snapshot made by saveSnapshot().
+   *
+   *  All options and arguments are reset to their default values and then get
+   *  the values from snapshot in the same order as in the original parse(), no
+   *  command line splitting or options files reading is done. Options and
+   *  arguments are not changed if the snapshot cannot be read. After loading,
+   *  saveSnapshot() writes the same snapshot again; reloadOptionsFiles() does
+   *  not know about the options files of the original parse().
+   *
+   *  @throw AppCmdException if snapshot is invalid, refers to unknown options,
+   *         or values cannot be converted.
+   */
+  void loadSnapshot ( std::istream& in ) ;
+
+  /// Where the value of an option came from, see provenance()
+  struct Provenance {
+    /// Kinds of sources
+    enum Source {
+      Default,      ///< Option was not given, it has default value
+      CommandLine,  ///< Value from command line
+      OptionsFile   ///< Value from options file
+    };
+    Provenance() : source(Default), word(0), file(), line(0), count(0) {}
+    Source source ;     ///< Source of the last value given to option
+    unsigned word ;     ///< Position of the option on command line (index in argv)
+    std::string file ;  ///< Path of the options file, included file for values from included files
+    unsigned line ;     ///< Line number in the options file, zero if not known
+    unsigned count ;    ///< Number of values given to option, can be more than one for lists
+  };
+
+  /**
+   *  @brief Get the source of the option value.
+   *
+   *  Sources are recorded by every parse() which stores values in options, in
+   *  a table with one small fixed-size entry per option, so recording does not
+   *  cost anything noticeable. For options which collect many values (lists)
+   *  the source of the last value is returned. After reloadOptionsFiles() changed
+   *  options have options file as a source, with unknown line number.
+   *
+   *  @throw AppCmdException if option is not known to the parser.
+   */
+  Provenance provenance ( const AppCmdOptBase& option ) const ;
+
+  /**
+   *  @brief Print sources of all option values.
+   *
+   *  One line per option: option name followed by "default", "cmdline:N", or
+   *  "file:PATH:LINE", and the number of values if there are more than one.
+   */
+  void dumpProvenance ( std::ostream& out ) const ;
+
+  /// Result of parsing one command line with parseBatch()
+  struct BatchResult {
+    BatchResult() : ok(false), helpWanted(false), error() {}
+    bool ok ;             ///< True if command line was parsed without errors
+    bool helpWanted ;     ///< True if help option was given, nothing else is parsed then
+    std::string error ;   ///< Error message if parsing failed
+  };
+
+  typedef std::vector<BatchResult> BatchResults ;
+
+  /**
+   *  @brief Parse many command lines in parallel.
+   *
+   *  Parses each command line in the same way as parse() does and returns the
+   *  result of parsing (success or error message) for each of them. This method
+   *  is supposed to be used for validation of large sets of command lines. Parsing
+   *  is done by the pool of threads, option and argument objects are not modified,
+   *  their values are kept in a per-thread AppCmdParseResult and discarded. Parser is compiled
+   *  first (see compile()) if it was not compiled yet. All option and argument
+   *  classes in this package support this mode, user-defined options and arguments
+   *  need to implement resetValue() and updateValue() methods.
+   *
+   *  @param[in] cmdlines  List of command lines, each command line is a list of words
+   *                       without application name (like in parse(Iter, Iter)).
+   *  @param[in] nThreads  Number of threads to use, 0 means number of hardware threads.
+   *  @return Vector of results, one result per command line in the same order.
+   *
+   *  @throw AppCmdException or a subclass of it if parser definitions are inconsistent.
+   */
+  BatchResults parseBatch ( const std::vector< std::vector<std::string> >& cmdlines, unsigned nThreads = 0 ) ;
+
   /**
    *  @brief Check whether -h or --help options were given.
    *
@@ -257,24 +569,190 @@ protected:
 
   // types
   typedef std::vector< std::string > StringList ;
+  typedef boost::string_ref WordRef ;
+  typedef std::vector< WordRef > WordList ;
   typedef std::vector< AppCmdArgBase* > PositionalsList ;
   typedef std::vector< AppCmdOptBase* > OptionsList ;
   typedef std::vector< AppCmdOptGroup* > GroupsList ;
 
+  // hash and equality for option names which work for both std::string and WordRef,
+  // used to look up option names without making strings
+  struct OptNameHash {
+    size_t operator()(WordRef name) const { return boost::hash_range(name.begin(), name.end()); }
+  };
+  struct OptNameEqual {
+    bool operator()(WordRef lhs, WordRef rhs) const { return lhs == rhs; }
+  };
+  typedef boost::unordered_map< std::string, size_t, OptNameHash, OptNameEqual > OptionsIndex ;
+
+  // options file contents used by last parse(), kept for reloadOptionsFiles()
+  struct OptFileRecord {
+    std::string path ;                // file path as given on command line
+    AppCmdOptFile::Stamp stamp ;      // modification time and size when file was read
+    std::vector< std::pair<std::string, AppCmdOptFile::Stamp> > includes ;  // canonical paths of all included files
+    std::vector< std::pair<size_t, std::string> > entries ;  // option index and value for every line
+    std::vector<std::string> originFiles ;  // paths of files which entries come from, as in provenance
+    std::vector< std::pair<unsigned, unsigned> > origins ;  // position in originFiles and line for every entry
+  };
+
+  // options file read by readOptionsFiles(), contents is zero if reading failed
+  struct OptFileData {
+    OptFileData() : contents(), error(), time(0) {}
+    boost::shared_ptr<const AppCmdOptFile> contents ;
+    std::string error ;   // error message if reading failed
+    double time ;         // time spent reading the file, seconds
+  };
+
+  // where the value of an option comes from
+  struct ValueSource {
+    explicit ValueSource(size_t word_) : word(word_), file(0), fileIndex(0), line(0) {}
+    ValueSource(const AppCmdOptFile* file_, unsigned fileIndex_, unsigned line_)
+      : word(0), file(file_), fileIndex(fileIndex_), line(line_) {}
+    size_t word ;                // position of the option on command line starting with 1, zero for files
+    const AppCmdOptFile* file ;  // options file or zero
+    unsigned fileIndex ;         // position of the file in ParseState::sourceFiles
+    unsigned line ;              // line number in options file
+  };
+
+  // source of the last value of one option, kept for every option, see provenance()
+  struct SourceEntry {
+    SourceEntry() : source(Provenance::Default), word(0), fileIndex(0), line(0), count(0) {}
+    Provenance::Source source ;
+    unsigned word ;
+    unsigned fileIndex ;  // position of the file in ParseState::sourceFiles
+    unsigned line ;
+    unsigned count ;
+  };
+
+  // value given to an option, recorded for saveSnapshot()
+  struct ValueRecord {
+    size_t optIndex ;
+    std::string value ;
+    std::string source ;  // "cmdline:N" or "file:PATH:LINE"
+  };
+
+  // options files included during one parse, key is the canonical path
+  typedef std::map< std::string, boost::shared_ptr<const AppCmdOptFile> > FragmentCache ;
+
+  // state of one parse() call
+  struct ParseState {
+    ParseState() : argvBuf(), wordEnds(), words(), iter(), args(), helpWanted(false), result(0), stats(0), optStats(),
+                   optFiles(), cmdlineOptions(), fragments(), recordValues(false), values(),
+                   sources(), sourceFiles(), batch(false) {}
+    std::string argvBuf ;            // all command line words, concatenated
+    std::vector<size_t> wordEnds ;   // end offset of every word in argvBuf
+    WordList words ;                 // views of individual words in argvBuf, filled by splitWords()
+    WordList::const_iterator iter ;  // current word
+    StringList args ;                // words given to positional arguments, filled by parseArgs()
+    bool helpWanted ;
+    AppCmdParseResult* result ;      // if not zero then values are stored here and not in options
+    AppCmdParseStats* stats ;        // if not zero then statistics of this call is collected here
+    std::vector<AppCmdParseStats::Counter> optStats ;  // per-option conversion statistics
+    std::vector<OptFileRecord> optFiles ;  // options files, filled only when values are stored in options
+    std::vector<bool> cmdlineOptions ;     // options set on command line, filled with optFiles
+    FragmentCache fragments ;              // included files, each is read once per parse
+    bool recordValues ;                    // if true then values given to options are recorded
+    std::vector<ValueRecord> values ;      // recorded values in the order they were given
+    std::vector<SourceEntry> sources ;     // source of every option value, filled with optFiles
+    std::vector<std::string> sourceFiles ; // paths of options files referred to by sources
+    bool batch ;                           // true in parseBatch() worker threads
+  };
+
+  // clear command line buffer
+  static void clearWords(ParseState& state) ;
+
+  // append one word to the command line buffer
+  static void appendWord(ParseState& state, const char* word) ;
+  static void appendWord(ParseState& state, const std::string& word) ;
+
+  // split command line buffer into words
+  static void splitWords(ParseState& state) ;
+
   // real parsing happens in this method
   virtual void doParse() ;
 
+  // parse command line words from state, options must be indexed already
+  void doParse(ParseState& state) const ;
+
+  // parse command line words from state into result object, parser must be compiled
+  void doParse(ParseState& state, AppCmdParseResult& result) const ;
+
+  // parse command line words from state, without collecting statistics
+  void parseWords(ParseState& state) const ;
+
+  // add statistics of one parse() call to the statistics object
+  void mergeStats(ParseState& state, double start, bool ok) const ;
+
+  // collect all options and arguments, check them for consistency and build index
+  void buildSchema() ;
+
+  // check that compiled parser was not modified
+  void checkSchema() const ;
+
+  // build full list of options from all groups
+  void allOptions(OptionsList& options) const ;
+
+  // build option name index for the list of options, throws on duplicate names
+  void buildIndex(const OptionsList& options) ;
+
   // parse options
-  virtual void parseOptions(const OptionsList& options) ;
+  virtual void parseOptions(ParseState& state) const ;
 
   // parse options file
-  virtual void parseOptionsFile(const OptionsList& options) ;
+  virtual void parseOptionsFile(ParseState& state) const ;
 
   // parse arguments
-  virtual void parseArgs() ;
+  virtual void parseArgs(ParseState& state) const ;
+
+  // give words in state.args to positional arguments
+  void assignArgs(ParseState& state) const ;
+
+  // read options file and find options for all its lines, throws on unknown options
+  void readOptionsFile(const std::string& path, OptFileRecord& record) const ;
+
+  // read and split options files, in parallel unless serial is true, errors are returned in data
+  void readOptionsFiles(const std::vector<std::string>& paths, std::vector<OptFileData>& data, bool serial) const ;
+
+  // read every step-th options file starting with first one, used by readOptionsFiles()
+  void readOptionsFilesRange(const std::vector<std::string>& paths, std::vector<OptFileData>& data,
+      size_t first, size_t step) const ;
+
+  // append entries of the options file to the list replacing include directives with
+  // entries of included files, key is the canonical path of the file or empty string,
+  // origins (if not zero) receives the file of every entry
+  void expandOptionsFile(const AppCmdOptFile& file, const std::string& key, FragmentCache& fragments,
+      std::vector<std::string>& stack, AppCmdOptFile::Entries& entries, OptFileRecord* record,
+      std::vector<const AppCmdOptFile*>* origins = 0) const ;
+
+  // returns true if any of the files in the record changed since they were read
+  static bool optionsFileChanged(const OptFileRecord& record) ;
+
+  // add entry origin to the record, lastOrigin and lastIndex remember the last origin file
+  static void addEntryOrigin(OptFileRecord& record, const AppCmdOptFile* origin, unsigned line,
+      const AppCmdOptFile*& lastOrigin, unsigned& lastIndex) ;
+
+  // position of the file in state.sourceFiles, file is added if it is not there
+  static unsigned sourceFileIndex(ParseState& state, const std::string& path) ;
+
+  // give value to an option, it is stored in option itself or in the value store
+  void setOptValue(ParseState& state, size_t optIndex, const std::string& value, const ValueSource& source) const ;
+
+  // parse every step-th command line starting with first one, used by parseBatch()
+  void parseBatchRange(const std::vector<StringList>& cmdlines, BatchResults& results,
+      size_t first, size_t step) const ;
+
+  // find option with the given name, returns its position in the list
+  // given to buildIndex() or -1 if option is not known
+  int findOptIndex ( WordRef opt ) const ;
 
   // find option with the given name
-  AppCmdOptBase* findOpt ( const std::string& opt, const OptionsList& options ) const ;
+  AppCmdOptBase* findOpt ( WordRef opt ) const ;
+
+  // find position of the option in the parser using name index, returns -1 if option is not known
+  int findOptIndex ( const AppCmdOptBase* opt ) const ;
+
+  // find position of the positional argument in the parser, returns -1 if argument is not known
+  int findArgIndex ( const AppCmdArgBase* arg ) const ;
 
   // format group of options
   void formatOptGroup(std::ostream& out, const std::string& groupName, const OptionsList& options, size_t optLen,
@@ -283,6 +761,7 @@ protected:
 private:
 
   // Friends
+  friend class AppCmdParseResult;
 
   // Data members
   GroupsList _groups;
@@ -290,12 +769,19 @@ private:
 
   std::string _argv0 ;
   AppCmdOptList<std::string>* _optionsFile ;
+  std::string _optionsFileCache ;
+  unsigned _optionsFileThreads ;  // threads for reading options files, 0 means default
+  bool _recordValues ;            // record option values for saveSnapshot()
 
-  StringList _argv ;
+  OptionsList _allOptions ;   // all options, filled by buildSchema()
+  OptionsIndex _optIndex ;    // maps option name to its position in _allOptions
+  int _optionsFileIndex ;     // position of options file option in _allOptions or -1
+  bool _compiled ;            // true after compile()
 
-  bool _helpWanted ;
-  StringList::const_iterator _iter ; // iterator used by doParse()
-  int _nWordsLeft ;                  // number of words not yet seen
+  ParseState _state ;         // state of the last parse() call
+
+  AppCmdParseStats* _stats ;  // parse statistics, not owned, may be zero
+  mutable boost::mutex _statsMutex ;  // protects _stats during parse
 
   // This class in non-copyable
   AppCmdLine( const AppCmdLine& );
@@ -310,11 +796,24 @@ template <typename Iter>
 void
 AppCmdLine::parse( Iter begin, Iter end )
 {
-  _argv.clear() ;
-  _argv.insert(_argv.end(), begin, end);
+  clearWords(_state) ;
+  for ( ; begin != end; ++ begin) {
+    appendWord(_state, *begin) ;
+  }
   return doParse() ;
 }
 
+template <typename Iter>
+void
+AppCmdLine::parse( Iter begin, Iter end, AppCmdParseResult& result ) const
+{
+  ParseState state ;
+  for ( ; begin != end; ++ begin) {
+    appendWord(state, *begin) ;
+  }
+  doParse(state, result) ;
+}
+
 } // namespace AppUtils
 
 
@@ -55,6 +55,10 @@ namespace AppUtils {
  *  line as '--option=ArgValue' or '--option ArgValue' or in options file as
  *  'option = ArgValue'.
  *
+ *  Option argument is normally converted to the option type when the option is
+ *  parsed. In lazy mode (see setLazy()) the text of the argument is saved instead
+ *  and converted when value() is called for the first time.
+ *
  *  This software was developed for the BaBar collaboration.  If you
  *  use all or part of it, please give an appropriate acknowledgement.
  *
@@ -129,7 +133,10 @@ public:
   /**
    *  Return current value of the argument
    */
-  virtual const value_type& value() const { return _value ; }
+  virtual const value_type& value() const {
+    if ( _pending ) convert() ;
+    return _value ;
+  }
 
 
   /**
@@ -137,6 +144,24 @@ public:
    */
   const value_type& defValue() const { return _defValue ; }
 
+  /**
+   *  @brief Enable or disable lazy conversion of option argument.
+   *
+   *  In lazy mode parser only saves the text of option argument, conversion to
+   *  the option type happens on the first call to value() and its result is kept.
+   *  Conversion errors are reported by value() then instead of parse(), call
+   *  AppCmdLine::validate() after parse() to convert all lazy options at once.
+   *  Because lazy option is modified by the first value() call it should not be
+   *  used by many threads before it is converted. Values stored in AppCmdParseResult
+   *  are always converted immediately.
+   */
+  void setLazy( bool lazy = true ) { _lazy = lazy ; }
+
+  /**
+   *  Returns true if lazy conversion is enabled.
+   */
+  bool lazy() const { return _lazy ; }
+
 protected:
 
   // Helper functions
@@ -168,7 +193,13 @@ private:
    *  @throw AppCmdException Thrown if string to value conversion fails.
    */
   virtual void setValue( const std::string& value ) {
-    _value = AppCmdTypeTraits<Type>::fromString ( value ) ;
+    if ( _lazy ) {
+      _text = value ;
+      _pending = true ;
+    } else {
+      _value = AppCmdTypeTraits<Type>::fromString ( value ) ;
+      _pending = false ;
+    }
     _changed = true ;
   }
 
@@ -179,13 +210,45 @@ private:
   virtual void reset() {
     _value = _defValue ;
     _changed = false ;
+    _pending = false ;
+    _text.clear() ;
+  }
+
+  /**
+   *  Reset value stored outside of option to option's default value.
+   */
+  virtual void resetValue( boost::any& value ) const {
+    value = _defValue ;
+  }
+
+  /**
+   *  Update value stored outside of option with option's argument.
+   */
+  virtual void updateValue( const std::string& str, boost::any& value ) const {
+    value = AppCmdTypeTraits<Type>::fromString ( str ) ;
   }
 
+  /**
+   *  Convert option argument if its conversion was deferred.
+   */
+  virtual void validate() const {
+    if ( _pending ) convert() ;
+  }
+
+  // convert saved text of the argument, option stays unconverted if this throws
+  void convert() const {
+    _value = AppCmdTypeTraits<Type>::fromString ( _text ) ;
+    _pending = false ;
+    _text.clear() ;
+  }
 
   // Data members
-  value_type _value ;
+  mutable value_type _value ;
   const value_type _defValue ;
   bool _changed ;
+  bool _lazy ;                  // if true then conversion is deferred
+  mutable bool _pending ;       // true if _text is not converted yet
+  mutable std::string _text ;   // text of the argument for lazy conversion
 
   // This class is non-copyable
   AppCmdOpt( const AppCmdOpt& );
@@ -200,6 +263,9 @@ AppCmdOpt<Type>::AppCmdOpt(const std::string& optNames, const std::string& name,
   , _value(defValue)
   , _defValue(defValue)
   , _changed(false)
+  , _lazy(false)
+  , _pending(false)
+  , _text()
 {
 }
 
@@ -210,6 +276,9 @@ AppCmdOpt<Type>::AppCmdOpt(AppCmdOptGroup& group, const std::string& optNames, c
   , _value(defValue)
   , _defValue(defValue)
   , _changed(false)
+  , _lazy(false)
+  , _pending(false)
+  , _text()
 {
   group.addOption(*this);
 }
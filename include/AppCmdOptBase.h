@@ -17,6 +17,7 @@
 //---------------
 #include <string>
 #include <vector>
+#include <boost/any.hpp>
 
 //----------------------
 // Base Class Headers --
@@ -131,6 +132,47 @@ protected:
    */
   virtual void reset() = 0 ;
 
+  /**
+   *  @brief Reset value stored outside of option to option's default value.
+   *
+   *  This method and updateValue() are used by parser instead of reset() and
+   *  setValue() when option values are stored outside of option objects, e.g.
+   *  when many command lines are parsed in parallel. They must not modify the
+   *  option object. Default implementation throws an exception, options which
+   *  do not implement these methods cannot be used in such parsing mode.
+   *
+   *  @param[out] value   Storage for the option value.
+   *
+   *  @throw AppCmdException if option does not support external storage.
+   */
+  virtual void resetValue( boost::any& value ) const ;
+
+  /**
+   *  @brief Update value stored outside of option with option's argument.
+   *
+   *  Same as setValue() but modifies value stored outside of option object.
+   *  Type of the stored value is the same as the type of value returned from
+   *  option's value() method.
+   *
+   *  @param[in] str      Option argument, empty if hasArgument() is false.
+   *  @param[in,out] value  Storage for the option value, initialized by resetValue().
+   *
+   *  @throw AppCmdException Thrown if string to value conversion fails.
+   */
+  virtual void updateValue( const std::string& str, boost::any& value ) const ;
+
+  /**
+   *  @brief Convert option argument if its conversion was deferred.
+   *
+   *  Options which support lazy conversion (see AppCmdOpt::setLazy()) keep the
+   *  text of their argument and convert it when their value is requested. This
+   *  method is called by AppCmdLine::validate() to do the conversion immediately.
+   *  Default implementation does nothing.
+   *
+   *  @throw AppCmdException Thrown if string to value conversion fails.
+   */
+  virtual void validate() const ;
+
   /**
    *  @brief Define an option.
    *
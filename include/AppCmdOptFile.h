@@ -0,0 +1,161 @@
+#ifndef APPUTILS_APPCMDOPTFILE_H
+#define APPUTILS_APPCMDOPTFILE_H
+
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Class AppCmdOptFile.
+//
+//------------------------------------------------------------------------
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include <string>
+#include <vector>
+#include <boost/scoped_ptr.hpp>
+#include <boost/utility/string_ref.hpp>
+
+//----------------------
+// Base Class Headers --
+//----------------------
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+#include "AppUtils/AppFileStamp.h"
+
+//------------------------------------
+// Collaborating Class Declarations --
+//------------------------------------
+struct stat;
+
+//		---------------------
+// 		-- Class Interface --
+//		---------------------
+
+namespace AppUtils {
+
+/// @addtogroup AppUtils
+
+/**
+ *  @ingroup AppUtils
+ *
+ *  @brief Contents of the options file split into option names and values.
+ *
+ *  Options file contains one option per line in the form "name = value"
+ *  or just "name" for options without argument. Empty lines and lines
+ *  starting with '#' are ignored, leading and trailing blanks in names and
+ *  values are removed. This class reads the file and splits it into the
+ *  sequence of name/value pairs, it does not know anything about options
+ *  defined in the parser, this is done by AppCmdLine. Include directives
+ *  ("@include path") appear as entries with the name includeDirective and
+ *  the path as a value, they are also expanded by AppCmdLine.
+ *
+ *  Regular files are memory-mapped and names and values refer to the mapped
+ *  memory, they stay valid while the instance of this class exists.
+ *
+ *  If the cache directory is given to constructor then split contents of
+ *  the file is also saved in that directory in a compact binary form. Next
+ *  time the same file (same absolute path) is read the cached contents is
+ *  used directly without any text parsing. Cached data is used only if size
+ *  and modification time of the file did not change since the cache was
+ *  written, or, if modification time changed, if the hash of the file contents
+ *  is the same. Otherwise the file is parsed again and the cache is replaced.
+ *  Cache file is written atomically so it is safe for many processes to
+ *  share the same cache directory. Any problems with reading or writing the
+ *  cache are ignored and the text of the file is parsed instead.
+ *
+ *  @note This software was developed for the LCLS project.  If you use all or
+ *  part of it, please give an appropriate acknowledgment.
+ *
+ *  @see AppCmdLine
+ *
+ *  @version $Id$
+ *
+ *  @author Andy Salnikov
+ */
+
+class AppCmdOptFile  {
+public:
+
+  /// One option line from the file.
+  struct Entry {
+    boost::string_ref name;   ///< Option name
+    boost::string_ref value;  ///< Option value, empty if not given
+    unsigned line;            ///< Line number in the file, first line is 1
+  };
+
+  typedef std::vector<Entry> Entries;
+
+  /// Name of the include directive, "@include path" or "@include = path"
+  static const char* const includeDirective;
+
+  /// Modification time and size of the file, used to detect changes of the file
+  typedef AppFileStamp Stamp;
+
+  /**
+   *  @brief Get modification time and size of a file without reading it.
+   *
+   *  @return false if the file does not exist or is not accessible.
+   */
+  static bool stamp(const std::string& path, Stamp& stamp);
+
+  /**
+   *  @brief Read and split options file.
+   *
+   *  @param[in] path      Path to the options file.
+   *  @param[in] cacheDir  Directory for the cache files, if empty then cache is not used.
+   *
+   *  @throw AppCmdException if file cannot be read.
+   */
+  explicit AppCmdOptFile(const std::string& path, const std::string& cacheDir = std::string());
+
+  // Destructor
+  ~AppCmdOptFile();
+
+  /// Returns path to the file as given to constructor
+  const std::string& path() const { return m_path; }
+
+  /// Returns all option lines from the file in the order they appear in the file
+  const Entries& entries() const { return m_entries; }
+
+  /// Returns true if contents was loaded from cache
+  bool fromCache() const { return m_fromCache; }
+
+  /// Returns modification time and size of the file when it was read
+  const Stamp& stamp() const { return m_stamp; }
+
+protected:
+
+private:
+
+  class Data;
+
+  // split text data into entries
+  void split();
+
+  // try to load entries from cache file, returns false if cache is not valid
+  bool loadCache(const std::string& cachePath, const std::string& absPath, const struct stat& st);
+
+  // save entries to cache file, errors are ignored
+  void saveCache(const std::string& cachePath, const std::string& absPath, const struct stat& st,
+      unsigned long long hash) const;
+
+  std::string m_path;
+  boost::scoped_ptr<Data> m_data;  ///< Mapped file data, entries refer to it
+  Entries m_entries;
+  bool m_fromCache;
+  Stamp m_stamp;
+
+  // This class is non-copyable
+  AppCmdOptFile(const AppCmdOptFile&);
+  AppCmdOptFile& operator=(const AppCmdOptFile&);
+
+};
+
+} // namespace AppUtils
+
+#endif // APPUTILS_APPCMDOPTFILE_H
@@ -153,6 +153,16 @@ private:
    */
   virtual void reset() ;
 
+  /**
+   *  Reset value stored outside of option to option's default value.
+   */
+  virtual void resetValue( boost::any& value ) const ;
+
+  /**
+   *  Update value stored outside of option with option's argument.
+   */
+  virtual void updateValue( const std::string& str, boost::any& value ) const ;
+
 
   // Data members
   value_type _value ;
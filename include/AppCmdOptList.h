@@ -17,6 +17,8 @@
 //---------------
 #include <vector>
 #include <algorithm>
+#include <cstring>
+#include <boost/type_traits/integral_constant.hpp>
 
 //----------------------
 // Base Class Headers --
@@ -69,6 +71,14 @@ namespace AppUtils {
  *
  *  Initial value of the option is always an empty list.
  *
+ *  For built-in numeric types the list is converted in bulk: separators are
+ *  located with memchr(), items are converted in place without making strings,
+ *  and the space for all items is reserved before conversion, so long lists
+ *  (e.g. 10^6 event numbers) are converted efficiently.
+ *
+ *  In lazy mode (see setLazy()) option arguments are saved as text and converted
+ *  when the value of the option is requested for the first time.
+ *
  *  This software was developed for the BaBar collaboration.  If you
  *  use all or part of it, please give an appropriate acknowledgement.
  *
@@ -143,19 +153,37 @@ public:
   /**
    *  Return current value of the argument
    */
-  virtual const container& value() const { return _value ; }
+  virtual const container& value() const { return converted() ; }
 
   /**
    *  Return iterator to the begin/end of sequence
    */
-  virtual const_iterator begin() const { return _value.begin() ; }
-  virtual const_iterator end() const { return _value.end() ; }
+  virtual const_iterator begin() const { return converted().begin() ; }
+  virtual const_iterator end() const { return converted().end() ; }
 
   /**
    *  Other usual container stuff
    */
-  size_type size() const { return _value.size() ; }
-  bool empty() const { return _value.empty() ; }
+  size_type size() const { return converted().size() ; }
+  bool empty() const { return converted().empty() ; }
+
+  /**
+   *  @brief Enable or disable lazy conversion of option arguments.
+   *
+   *  In lazy mode parser only saves the text of option arguments, they are split
+   *  and converted on the first call to any method which accesses the value of the
+   *  option and the result is kept. Conversion errors are reported by these methods
+   *  then instead of parse(), call AppCmdLine::validate() after parse() to convert
+   *  all lazy options at once. Because lazy option is modified by the first access
+   *  it should not be used by many threads before it is converted. Values stored in
+   *  AppCmdParseResult are always converted immediately.
+   */
+  void setLazy( bool lazy = true ) { _lazy = lazy ; }
+
+  /**
+   *  Returns true if lazy conversion is enabled.
+   */
+  bool lazy() const { return _lazy ; }
 
 protected:
 
@@ -186,12 +214,56 @@ private:
   virtual void reset() {
     _value.clear() ;
     _changed = false ;
+    _texts.clear() ;
+  }
+
+  /**
+   *  Reset value stored outside of option to option's default value.
+   */
+  virtual void resetValue( boost::any& value ) const {
+    value = container() ;
+  }
+
+  /**
+   *  Update value stored outside of option with option's argument.
+   */
+  virtual void updateValue( const std::string& str, boost::any& value ) const {
+    appendValues ( str, boost::any_cast<container&>(value) ) ;
+  }
+
+  /**
+   *  Convert option arguments if their conversion was deferred.
+   */
+  virtual void validate() const {
+    converted() ;
   }
 
+  // convert saved arguments if there are any and return the value
+  const container& converted() const {
+    if ( not _texts.empty() ) convert() ;
+    return _value ;
+  }
+
+  // convert saved arguments, arguments which fail to convert stay unconverted
+  void convert() const ;
+
+  // split the string and append converted values to container
+  void appendValues( const std::string& str, container& cont ) const {
+    appendValues ( str, cont, boost::integral_constant<bool, detail::AppCmdFromChars<Type>::supported>() ) ;
+  }
+
+  // generic implementation, converts each item via AppCmdTypeTraits
+  void appendValues( const std::string& str, container& cont, boost::false_type ) const ;
+
+  // bulk implementation for numeric types
+  void appendValues( const std::string& str, container& cont, boost::true_type ) const ;
+
   // Data members
   const char _separator ;
-  container _value ;
+  mutable container _value ;
   bool _changed ;
+  bool _lazy ;                                // if true then conversion is deferred
+  mutable std::vector<std::string> _texts ;   // arguments which are not converted yet
 
   // This class in non-copyable
   AppCmdOptList(const AppCmdOptList&);
@@ -206,6 +278,8 @@ AppCmdOptList<Type>::AppCmdOptList(const std::string& optNames, const std::strin
   , _separator(separator)
   , _value()
   , _changed(false)
+  , _lazy(false)
+  , _texts()
 {
 }
 
@@ -216,6 +290,8 @@ AppCmdOptList<Type>::AppCmdOptList(AppCmdOptGroup& group, const std::string& opt
   , _separator(separator)
   , _value()
   , _changed(false)
+  , _lazy(false)
+  , _texts()
 {
   group.addOption(*this);
 }
@@ -224,6 +300,37 @@ AppCmdOptList<Type>::AppCmdOptList(AppCmdOptGroup& group, const std::string& opt
 template <typename Type>
 void
 AppCmdOptList<Type>::setValue(const std::string& value)
+{
+  if ( _lazy ) {
+    _texts.push_back(value);
+  } else {
+    appendValues(value, _value);
+  }
+  _changed = true ;
+}
+
+// Convert saved arguments.
+template <typename Type>
+void
+AppCmdOptList<Type>::convert() const
+{
+  typedef std::vector<std::string>::size_type Index ;
+  for ( Index i = 0 ; i != _texts.size() ; ++ i ) {
+    try {
+      appendValues(_texts[i], _value);
+    } catch (...) {
+      // keep failed and following arguments for the next attempt
+      _texts.erase(_texts.begin(), _texts.begin() + i);
+      throw ;
+    }
+  }
+  _texts.clear() ;
+}
+
+// Split the string and append converted values to container.
+template <typename Type>
+void
+AppCmdOptList<Type>::appendValues(const std::string& value, container& cont, boost::false_type) const
 {
   container localCont ;
 
@@ -244,8 +351,43 @@ AppCmdOptList<Type>::setValue(const std::string& value)
   } while ( pos != value.end() ) ;
 
   // copy from local container to value
-  _value.insert(_value.end(), localCont.begin(), localCont.end());
-  _changed = true ;
+  cont.insert(cont.end(), localCont.begin(), localCont.end());
+}
+
+// Split the string and append converted values to container, numeric types.
+template <typename Type>
+void
+AppCmdOptList<Type>::appendValues(const std::string& value, container& cont, boost::true_type) const
+{
+  const char* pos = value.data() ;
+  const char* const end = pos + value.size() ;
+
+  // reserve space for all items, separator at the end does not start new item
+  size_type nItems = std::count ( pos, end, _separator ) + 1 ;
+  if ( pos != end and *(end-1) == _separator ) -- nItems ;
+  const size_type oldSize = cont.size() ;
+  if ( cont.capacity() < oldSize + nItems ) {
+    cont.reserve ( std::max ( oldSize + nItems, 2*cont.capacity() ) ) ;
+  }
+
+  do {
+
+    // get next item from the string
+    const char* pos1 = static_cast<const char*>( std::memchr ( pos, _separator, end - pos ) ) ;
+    if ( not pos1 ) pos1 = end ;
+    Type res ;
+    if ( not detail::AppCmdFromChars<Type>::convert ( pos, pos1, res ) ) {
+      // leave container unchanged
+      cont.resize ( oldSize ) ;
+      throw AppCmdTypeCvtException ( std::string ( pos, pos1 ), detail::AppCmdFromChars<Type>::typeName() ) ;
+    }
+    cont.push_back( res ) ;
+
+    // advance
+    pos = pos1 ;
+    if ( pos != end ) ++ pos ;
+
+  } while ( pos != end ) ;
 }
 
 } // namespace AppUtils
@@ -203,6 +203,23 @@ private:
     _changed = false ;
   }
 
+  /**
+   *  Reset value stored outside of option to option's default value.
+   */
+  virtual void resetValue( boost::any& value ) const {
+    value = _defValue ;
+  }
+
+  /**
+   *  Update value stored outside of option with option's argument.
+   */
+  virtual void updateValue( const std::string& str, boost::any& value ) const {
+    value = lookup ( str ) ;
+  }
+
+  // find value for a given string, throws if string is not known
+  const value_type& lookup( const std::string& str ) const ;
+
 
   // Types
   typedef std::map< std::string, value_type > String2Value ;
@@ -250,12 +267,18 @@ AppCmdOptNamedValue<Type>::AppCmdOptNamedValue(AppCmdOptGroup& group, const std:
 template <typename Type>
 void
 AppCmdOptNamedValue<Type>::setValue ( const std::string& valueStr )
+{
+  _value = lookup ( valueStr ) ;
+  _changed = true ;
+}
+
+template <typename Type>
+const Type&
+AppCmdOptNamedValue<Type>::lookup ( const std::string& valueStr ) const
 {
   typename String2Value::const_iterator it = _str2value.find ( valueStr ) ;
   if ( it == _str2value.end() ) throw AppCmdTypeCvtException ( valueStr, "<map type>" ) ;
-
-  _value = it->second ;
-  _changed = true ;
+  return it->second ;
 }
 
 } // namespace AppUtils
@@ -0,0 +1,457 @@
+#ifndef APPUTILS_APPCMDOPTRANGELIST_H
+#define APPUTILS_APPCMDOPTRANGELIST_H
+
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Class AppCmdOptRangeList.
+//
+//------------------------------------------------------------------------
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <boost/type_traits/make_unsigned.hpp>
+
+//----------------------
+// Base Class Headers --
+//----------------------
+#include "AppUtils/AppCmdOptBase.h"
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+#include "AppUtils/AppCmdExceptions.h"
+#include "AppUtils/AppCmdOptGroup.h"
+#include "AppUtils/AppCmdTypeTraits.h"
+
+//------------------------------------
+// Collaborating Class Declarations --
+//------------------------------------
+
+//		---------------------
+// 		-- Class Interface --
+//		---------------------
+
+namespace AppUtils {
+
+/// @addtogroup AppUtils
+
+/**
+ *  @ingroup AppUtils
+ *
+ *  @brief Set of integer numbers stored as a list of ranges.
+ *
+ *  Each range is defined by its first and last value and a stride, it contains
+ *  numbers first, first+stride, first+2*stride, ..., last. Ranges are kept sorted
+ *  by their first value, membership test is a binary search which takes
+ *  O(log n) time for non-overlapping ranges. This is the value type of the
+ *  AppCmdOptRangeList option.
+ *
+ *  @note This software was developed for the LCLS project.  If you use all or
+ *  part of it, please give an appropriate acknowledgment.
+ *
+ *  @see AppCmdOptRangeList
+ *
+ *  @version $Id$
+ *
+ *  @author Andy Salnikov
+ */
+
+template <typename Type>
+class AppCmdRangeList {
+public:
+
+  /// One range of numbers
+  struct Range {
+    Type first ;    ///< First number in a range
+    Type last ;     ///< Last number in a range, always first + n*stride
+    Type stride ;   ///< Distance between numbers, positive
+  };
+
+  typedef std::vector<Range> container ;
+  typedef typename container::const_iterator const_iterator ;
+  typedef typename container::size_type size_type ;
+
+  /// Make empty set
+  AppCmdRangeList() : _ranges(), _maxLast() {}
+
+  /// Returns true if number belongs to any range
+  bool contains(Type value) const ;
+
+  /// Returns total count of numbers in all ranges, numbers in overlapping ranges are counted more than once.
+  /// Count which does not fit into unsigned long long (e.g. range covering all 64-bit numbers) is saturated
+  /// to the maximum unsigned long long value.
+  unsigned long long count() const ;
+
+  /// Returns iterator to the first range, ranges are sorted by their first value
+  const_iterator begin() const { return _ranges.begin() ; }
+
+  /// Returns iterator past the last range
+  const_iterator end() const { return _ranges.end() ; }
+
+  /// Returns number of ranges
+  size_type size() const { return _ranges.size() ; }
+
+  /// Returns true if there are no ranges
+  bool empty() const { return _ranges.empty() ; }
+
+  /// Remove all ranges
+  void clear() {
+    _ranges.clear() ;
+    _maxLast.clear() ;
+  }
+
+  /**
+   *  @brief Add ranges parsed from a string.
+   *
+   *  String contains comma-separated (or separated by other separator character)
+   *  list of items, each item is either a single number "N", a range "N-M" with
+   *  both ends included, or a range with a stride "N-M:S". Numbers use the same
+   *  syntax as integer types in AppCmdTypeTraits. If string cannot be parsed then
+   *  exception is thrown and the set is not changed.
+   *
+   *  @throw AppCmdTypeCvtException if string cannot be parsed.
+   */
+  void add(const std::string& str, char separator = ',') ;
+
+  /**
+   *  @brief Add one range.
+   *
+   *  Last number is adjusted down to first + n*stride.
+   *
+   *  @throw AppCmdException if last is less than first or stride is not positive.
+   */
+  void add(Type first, Type last, Type stride = 1) ;
+
+private:
+
+  typedef typename boost::make_unsigned<Type>::type UType ;
+
+  // order ranges by their first value
+  static bool lessFirst(const Range& lhs, const Range& rhs) { return lhs.first < rhs.first ; }
+
+  // parse one item into range, returns false on errors
+  static bool parseItem(const char* begin, const char* end, Range& range) ;
+
+  // parse one number
+  static bool parseNumber(const char* begin, const char* end, Type& value) ;
+
+  // sort ranges added after first oldSize and update _maxLast
+  void merge(size_type oldSize) ;
+
+  container _ranges ;
+  std::vector<Type> _maxLast ;   // maximum of last values for all ranges up to and including this one
+
+};
+
+/**
+ *  @ingroup AppUtils
+ *
+ *  @brief Option class collecting integer numbers and ranges of numbers.
+ *
+ *  This option is intended for large selections of integer numbers like
+ *  run or event numbers. Its argument is a list of single numbers or ranges
+ *  of numbers with optional stride, for example "1-100,200-300:5,1000" (see
+ *  AppCmdRangeList::add() for details). Unlike AppCmdOptList<int> ranges are not
+ *  expanded into individual numbers, memory and time needed to parse and store
+ *  the option do not depend on the size of the ranges. Value of the option is an
+ *  instance of AppCmdRangeList which can be used to check whether number belongs
+ *  to the selection.
+ *
+ *  If option appears multiple times on the command line or in the options file
+ *  all ranges are collected together. Initial value of the option is always
+ *  an empty set.
+ *
+ *  @note This software was developed for the LCLS project.  If you use all or
+ *  part of it, please give an appropriate acknowledgment.
+ *
+ *  @see AppCmdRangeList
+ *  @see AppCmdOptList
+ *
+ *  @version $Id$
+ *
+ *  @author Andy Salnikov
+ */
+
+template <typename Type>
+class AppCmdOptRangeList : public AppCmdOptBase {
+public:
+
+  typedef AppCmdRangeList<Type> value_type ;
+
+  /**
+   *  @brief Define an option with a required argument.
+   *
+   *  After option is instantiated it has to be added to parser using
+   *  AppCmdLine::addOption() method. To get current value of option argument
+   *  use value() method.
+   *
+   *  @param[in] optNames    Comma-separated option names.
+   *  @param[in] name        Name for option argument, something like "runs", "events", etc. Used
+   *                         only for information purposes when usage() is called.
+   *  @param[in] descr       Long description for the option, printed when usage() is called.
+   *  @param[in] separator   Separator character for splitting argument into ranges.
+   */
+  AppCmdOptRangeList(const std::string& optNames, const std::string& name, const std::string& descr,
+      char separator = ',')
+    : AppCmdOptBase(optNames, name, descr)
+    , _separator(separator)
+    , _value()
+    , _changed(false)
+  {
+  }
+
+  /**
+   *  @brief Define an option with a required argument.
+   *
+   *  This constructor automatically adds instantiated option to a parser.
+   *  This method may throw an exception if the option name conflicts with the previously
+   *  added options.
+   *
+   *  @param[in] group       Option group (or parser instance) to which this option will be added.
+   *  @param[in] optNames    Comma-separated option names.
+   *  @param[in] name        Name for option argument, something like "runs", "events", etc. Used
+   *                         only for information purposes when usage() is called.
+   *  @param[in] descr       Long description for the option, printed when usage() is called.
+   *  @param[in] separator   Separator character for splitting argument into ranges.
+   */
+  AppCmdOptRangeList(AppCmdOptGroup& group, const std::string& optNames, const std::string& name,
+      const std::string& descr, char separator = ',')
+    : AppCmdOptBase(optNames, name, descr)
+    , _separator(separator)
+    , _value()
+    , _changed(false)
+  {
+    group.addOption(*this);
+  }
+
+  /// Destructor
+  virtual ~AppCmdOptRangeList( ) {}
+
+  /**
+   *  True if the value of the option was changed from command line.
+   */
+  virtual bool valueChanged() const { return _changed ; }
+
+  /**
+   *  Return current value of the argument
+   */
+  virtual const value_type& value() const { return _value ; }
+
+  /**
+   *  Returns true if number belongs to any range
+   */
+  bool contains(Type value) const { return _value.contains(value) ; }
+
+protected:
+
+private:
+
+  /**
+   *  Returns true if option requires argument.
+   */
+  virtual bool hasArgument() const { return true ; }
+
+  /**
+   *  @brief Set option's argument.
+   *
+   *  @throw AppCmdException Thrown if string to value conversion fails.
+   */
+  virtual void setValue( const std::string& value ) {
+    _value.add ( value, _separator ) ;
+    _changed = true ;
+  }
+
+  /**
+   *  Reset option to its default value, clear changed flag
+   */
+  virtual void reset() {
+    _value.clear() ;
+    _changed = false ;
+  }
+
+  /**
+   *  Reset value stored outside of option to option's default value.
+   */
+  virtual void resetValue( boost::any& value ) const {
+    value = value_type() ;
+  }
+
+  /**
+   *  Update value stored outside of option with option's argument.
+   */
+  virtual void updateValue( const std::string& str, boost::any& value ) const {
+    boost::any_cast<value_type&>(value).add ( str, _separator ) ;
+  }
+
+  // Data members
+  const char _separator ;
+  value_type _value ;
+  bool _changed ;
+
+  // This class in non-copyable
+  AppCmdOptRangeList(const AppCmdOptRangeList&);
+  AppCmdOptRangeList& operator=(const AppCmdOptRangeList&);
+
+};
+
+// Returns true if number belongs to any range
+template <typename Type>
+bool
+AppCmdRangeList<Type>::contains(Type value) const
+{
+  // ranges which start after the value cannot contain it
+  Range key ;
+  key.first = value ;
+  size_type idx = std::upper_bound(_ranges.begin(), _ranges.end(), key, lessFirst) - _ranges.begin() ;
+
+  // look at preceding ranges while some of them end after the value
+  while (idx > 0) {
+    -- idx ;
+    if (_maxLast[idx] < value) break ;
+    const Range& range = _ranges[idx] ;
+    if (value <= range.last and (UType(value) - UType(range.first)) % UType(range.stride) == 0) return true ;
+  }
+  return false ;
+}
+
+// Returns total count of numbers in all ranges, saturates on overflow
+template <typename Type>
+unsigned long long
+AppCmdRangeList<Type>::count() const
+{
+  const unsigned long long maxCount = std::numeric_limits<unsigned long long>::max() ;
+  unsigned long long count = 0 ;
+  for (const_iterator it = _ranges.begin(); it != _ranges.end(); ++ it) {
+    // number of steps fits, one more number may not
+    const unsigned long long steps = (UType(it->last) - UType(it->first)) / UType(it->stride) ;
+    if (steps >= maxCount - count) return maxCount ;
+    count += steps + 1 ;
+  }
+  return count ;
+}
+
+// Add ranges parsed from a string.
+template <typename Type>
+void
+AppCmdRangeList<Type>::add(const std::string& str, char separator)
+{
+  const size_type oldSize = _ranges.size() ;
+
+  const char* pos = str.data() ;
+  const char* const end = pos + str.size() ;
+  do {
+
+    // get next item from the string
+    const char* pos1 = static_cast<const char*>( std::memchr ( pos, separator, end - pos ) ) ;
+    if ( not pos1 ) pos1 = end ;
+    Range range ;
+    if ( not parseItem ( pos, pos1, range ) ) {
+      // leave the set unchanged
+      _ranges.resize ( oldSize ) ;
+      throw AppCmdTypeCvtException ( std::string ( pos, pos1 ), "integer range" ) ;
+    }
+    _ranges.push_back( range ) ;
+
+    // advance
+    pos = pos1 ;
+    if ( pos != end ) ++ pos ;
+
+  } while ( pos != end ) ;
+
+  merge ( oldSize ) ;
+}
+
+// Add one range.
+template <typename Type>
+void
+AppCmdRangeList<Type>::add(Type first, Type last, Type stride)
+{
+  if (last < first or stride <= 0) {
+    throw AppCmdException ( "invalid range: last is less than first or stride is not positive" ) ;
+  }
+  Range range ;
+  range.first = first ;
+  range.stride = stride ;
+  range.last = Type( UType(first) + (UType(last) - UType(first)) / UType(stride) * UType(stride) ) ;
+  const size_type oldSize = _ranges.size() ;
+  _ranges.push_back( range ) ;
+  merge ( oldSize ) ;
+}
+
+// parse one item into range
+template <typename Type>
+bool
+AppCmdRangeList<Type>::parseItem(const char* begin, const char* end, Range& range)
+{
+  // leading blanks are allowed before numbers but not before dash
+  while (begin != end and (*begin == ' ' or *begin == '\t')) ++ begin ;
+  if (begin == end) return false ;
+
+  // stride follows colon
+  const char* colon = static_cast<const char*>( std::memchr ( begin, ':', end - begin ) ) ;
+  Type stride = 1 ;
+  if (colon) {
+    if (not parseNumber ( colon + 1, end, stride ) or stride <= 0) return false ;
+    end = colon ;
+  }
+
+  // dash separates first and last numbers, dash at the start is a sign
+  const char* dash = static_cast<const char*>( std::memchr ( begin + 1, '-', end - begin - 1 ) ) ;
+  if (not dash) {
+    // single number, stride is not allowed
+    if (colon) return false ;
+    if (not parseNumber ( begin, end, range.first )) return false ;
+    range.last = range.first ;
+    range.stride = 1 ;
+    return true ;
+  }
+
+  Type last ;
+  if (not parseNumber ( begin, dash, range.first ) or not parseNumber ( dash + 1, end, last )) return false ;
+  if (last < range.first) return false ;
+  range.stride = stride ;
+  range.last = Type( UType(range.first) + (UType(last) - UType(range.first)) / UType(stride) * UType(stride) ) ;
+  return true ;
+}
+
+// parse one number
+template <typename Type>
+bool
+AppCmdRangeList<Type>::parseNumber(const char* begin, const char* end, Type& value)
+{
+  // unsigned types do not accept negative numbers here
+  if (not std::numeric_limits<Type>::is_signed) {
+    const char* p = std::find ( begin, end, '-' ) ;
+    if (p != end) return false ;
+  }
+  return detail::AppCmdFromChars<Type>::convert ( begin, end, value ) ;
+}
+
+// sort newly added ranges and update _maxLast
+template <typename Type>
+void
+AppCmdRangeList<Type>::merge(size_type oldSize)
+{
+  typedef typename container::iterator iterator ;
+  const iterator mid = _ranges.begin() + oldSize ;
+  std::sort ( mid, _ranges.end(), lessFirst ) ;
+  std::inplace_merge ( _ranges.begin(), mid, _ranges.end(), lessFirst ) ;
+
+  _maxLast.resize ( _ranges.size() ) ;
+  for (size_type i = 0; i != _ranges.size(); ++ i) {
+    _maxLast[i] = i == 0 ? _ranges[i].last : std::max ( _maxLast[i-1], _ranges[i].last ) ;
+  }
+}
+
+} // namespace AppUtils
+
+#endif // APPUTILS_APPCMDOPTRANGELIST_H
@@ -0,0 +1,180 @@
+#ifndef APPUTILS_APPCMDPARSERESULT_H
+#define APPUTILS_APPCMDPARSERESULT_H
+
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Class AppCmdParseResult.
+//
+//------------------------------------------------------------------------
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include <string>
+#include <vector>
+#include <boost/any.hpp>
+
+//----------------------
+// Base Class Headers --
+//----------------------
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+
+//------------------------------------
+// Collaborating Class Declarations --
+//------------------------------------
+namespace AppUtils {
+class AppCmdLine ;
+class AppCmdOptBase ;
+class AppCmdArgBase ;
+class AppCmdOptIncr ;
+class AppCmdOptToggle ;
+class AppCmdOptBool ;
+class AppCmdOptSize ;
+template <typename T> class AppCmdOpt ;
+template <typename T> class AppCmdOptList ;
+template <typename T> class AppCmdOptNamedValue ;
+template <typename T> class AppCmdOptRangeList ;
+template <typename T> class AppCmdRangeList ;
+template <typename T> class AppCmdArg ;
+template <typename T> class AppCmdArgList ;
+}
+
+//		---------------------
+// 		-- Class Interface --
+//		---------------------
+
+namespace AppUtils {
+
+/// @addtogroup AppUtils
+
+/**
+ *  @ingroup AppUtils
+ *
+ *  @brief Values of options and arguments from one parsed command line.
+ *
+ *  Regular AppCmdLine::parse() methods store parsed values in the option and
+ *  argument objects themselves, so one parser can only parse one command line
+ *  at a time. Alternatively the values can be stored in an instance of this
+ *  class, option and argument objects are not modified in this case and the
+ *  same compiled parser can be used by many threads at the same time, each
+ *  thread needs its own instance of this class:
+ *
+ *  @code
+ *  AppCmdLine cmdline(argv[0]);
+ *  AppCmdOptIncr optVerbose("verbose,v", "produce more noise", 0);
+ *  cmdline.addOption(optVerbose);
+ *  AppCmdArg<std::string> argName("name", "specifies the name of the game");
+ *  cmdline.addArgument(argName);
+ *  cmdline.compile();
+ *
+ *  // this can be done in many threads
+ *  AppCmdParseResult result;
+ *  cmdline.parse(words.begin(), words.end(), result);
+ *  if (result.value(optVerbose) > 1) {
+ *    std::cout << "Starting game " << result.value(argName) << std::endl;
+ *  }
+ *  @endcode
+ *
+ *  Values are retrieved with the overloaded value() methods which take the
+ *  option or argument object as a key and return value of the same type as
+ *  the value() method of that option or argument. Options and arguments which
+ *  are not known to the parser cause an exception. Instance of this class can
+ *  be reused for many parse() calls, it keeps the results of the last one. The
+ *  parser and its options must outlive the result.
+ *
+ *  @note This software was developed for the LCLS project.  If you use all or
+ *  part of it, please give an appropriate acknowledgment.
+ *
+ *  @see AppCmdLine
+ *
+ *  @version $Id$
+ *
+ *  @author Andy Salnikov
+ */
+
+class AppCmdParseResult  {
+public:
+
+  /// Make empty result, it cannot be used before it is passed to parse()
+  AppCmdParseResult() ;
+
+  // Destructor
+  ~AppCmdParseResult() ;
+
+  /// Returns true if -h or --help option was given, other values are not set then
+  bool helpWanted() const { return _helpWanted; }
+
+  /**
+   *  @brief True if the value of the option was changed from command line.
+   *
+   *  @throw AppCmdException if option is not known to the parser.
+   */
+  bool valueChanged(const AppCmdOptBase& opt) const ;
+
+  /**
+   *  @brief Get the value of the option or argument.
+   *
+   *  @throw AppCmdException if option or argument is not known to the parser.
+   */
+  int value(const AppCmdOptIncr& opt) const ;
+  bool value(const AppCmdOptToggle& opt) const ;
+  bool value(const AppCmdOptBool& opt) const ;
+  unsigned long long value(const AppCmdOptSize& opt) const ;
+
+  template <typename T>
+  const T& value(const AppCmdOpt<T>& opt) const
+    { return boost::any_cast<const T&>(optValue(opt)); }
+
+  template <typename T>
+  const std::vector<T>& value(const AppCmdOptList<T>& opt) const
+    { return boost::any_cast<const std::vector<T>&>(optValue(opt)); }
+
+  template <typename T>
+  const T& value(const AppCmdOptNamedValue<T>& opt) const
+    { return boost::any_cast<const T&>(optValue(opt)); }
+
+  template <typename T>
+  const AppCmdRangeList<T>& value(const AppCmdOptRangeList<T>& opt) const
+    { return boost::any_cast<const AppCmdRangeList<T>&>(optValue(opt)); }
+
+  template <typename T>
+  const T& value(const AppCmdArg<T>& arg) const
+    { return boost::any_cast<const T&>(argValue(arg)); }
+
+  template <typename T>
+  const std::vector<T>& value(const AppCmdArgList<T>& arg) const
+    { return boost::any_cast<const std::vector<T>&>(argValue(arg)); }
+
+protected:
+
+private:
+
+  // parser fills all data members
+  friend class AppCmdLine;
+
+  // get stored option value, throws if option is not known
+  const boost::any& optValue(const AppCmdOptBase& opt) const ;
+
+  // get stored argument value, throws if argument is not known
+  const boost::any& argValue(const AppCmdArgBase& arg) const ;
+
+  // get position of the option in the parser, throws if option is not known
+  size_t optIndex(const AppCmdOptBase& opt) const ;
+
+  const AppCmdLine* _parser ;          // parser which filled this result
+  std::vector<boost::any> _options ;   // option values, same order as options in parser
+  std::vector<bool> _optionsChanged ;  // true for options set on command line or in options file
+  std::vector<boost::any> _args ;      // positional argument values
+  bool _helpWanted ;
+
+};
+
+} // namespace AppUtils
+
+#endif // APPUTILS_APPCMDPARSERESULT_H
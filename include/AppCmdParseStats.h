@@ -0,0 +1,189 @@
+#ifndef APPUTILS_APPCMDPARSESTATS_H
+#define APPUTILS_APPCMDPARSESTATS_H
+
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Class AppCmdParseStats.
+//
+//------------------------------------------------------------------------
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include <iosfwd>
+#include <map>
+#include <string>
+
+//----------------------
+// Base Class Headers --
+//----------------------
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+
+//------------------------------------
+// Collaborating Class Declarations --
+//------------------------------------
+
+//		---------------------
+// 		-- Class Interface --
+//		---------------------
+
+namespace AppUtils {
+
+/// @addtogroup AppUtils
+
+/**
+ *  @ingroup AppUtils
+ *
+ *  @brief Timing and counters collected by AppCmdLine during parsing.
+ *
+ *  Instance of this class is given to AppCmdLine::setParseStats() and after
+ *  that every parse() call of that parser adds its numbers to it:
+ *
+ *  @code
+ *  AppCmdParseStats stats;
+ *  cmdline.setParseStats(&stats);
+ *  cmdline.parse(argc, argv);
+ *  stats.dump(std::cout);
+ *  @endcode
+ *
+ *  Parsing is split into phases (splitting command line into words, reset of
+ *  options to their defaults, parsing of options, options files and positional
+ *  arguments), for each phase the number of calls, total time and the number
+ *  of processed items is recorded. Similar counters are kept for each options
+ *  file (items are the entries in the file) and for each option (calls are
+ *  the conversions of option values, items are the characters converted). Instead of counting memory allocations
+ *  which is not possible without replacing global operator new, parser counts
+ *  the strings that it makes for option values and positional arguments and
+ *  their total size.
+ *
+ *  Statistics from parseBatch() and from the const parse() methods running
+ *  in many threads are accumulated in the same object, parser synchronizes
+ *  updates. Methods of this class itself are not synchronized, the numbers
+ *  should be read when parser is not running.
+ *
+ *  @note This software was developed for the LCLS project.  If you use all or
+ *  part of it, please give an appropriate acknowledgment.
+ *
+ *  @see AppCmdLine
+ *
+ *  @version $Id$
+ *
+ *  @author Andy Salnikov
+ */
+
+class AppCmdParseStats  {
+public:
+
+  /// Phases of parsing
+  enum Phase {
+    Split,        ///< splitting command line into words
+    Reset,        ///< reset of options and arguments to default values
+    Options,      ///< parsing options on command line
+    OptionsFile,  ///< parsing options files
+    Args,         ///< parsing positional arguments
+    NPhases
+  };
+
+  /// Counters for one phase, options file, or option
+  struct Counter {
+    Counter() : count(0), items(0), time(0) {}
+    unsigned long long count ;  ///< Number of calls
+    unsigned long long items ;  ///< Number of processed items (words, entries, values)
+    double time ;               ///< Total time in seconds
+
+    /// Add one call
+    void add(double sec, unsigned long long nItems) { ++ count; items += nItems; time += sec; }
+
+    /// Add counters from other instance
+    void merge(const Counter& other) { count += other.count; items += other.items; time += other.time; }
+  };
+
+  typedef std::map<std::string, Counter> CounterMap ;
+
+  /// Make empty statistics
+  AppCmdParseStats() ;
+
+  // Destructor
+  ~AppCmdParseStats() ;
+
+  /// Reset all counters
+  void clear() ;
+
+  /// Counters for whole parse() calls, items are the command line words
+  const Counter& total() const { return _total; }
+
+  /// Number of parse() calls which threw an exception
+  unsigned long long failures() const { return _failures; }
+
+  /// Counters for one phase of parsing
+  const Counter& phase(Phase phase) const { return _phases[phase]; }
+
+  /// Counters for options files, key is the file name
+  const CounterMap& files() const { return _files; }
+
+  /// Counters for option conversions, key is the long option name (or short if there is no long one)
+  const CounterMap& options() const { return _options; }
+
+  /// Number of strings made for option values and arguments
+  unsigned long long strings() const { return _strings; }
+
+  /// Total size of strings made for option values and arguments and of command line buffer
+  unsigned long long stringBytes() const { return _stringBytes; }
+
+  /// Add counters from other instance
+  void merge(const AppCmdParseStats& other) ;
+
+  /// Dump all counters in JSON format
+  void dump(std::ostream& out) const ;
+
+  /// Return name of the phase
+  static const char* phaseName(Phase phase) ;
+
+  /// Return current time in seconds from some arbitrary moment, monotonic
+  static double now() ;
+
+  // these are used by the parser
+  Counter& total() { return _total; }
+  void addFailure() { ++ _failures; }
+  Counter& phase(Phase phase) { return _phases[phase]; }
+  Counter& file(const std::string& name) { return _files[name]; }
+  Counter& option(const std::string& name) { return _options[name]; }
+  void addString(unsigned long long size) { ++ _strings; _stringBytes += size; }
+  void addBytes(unsigned long long size) { _stringBytes += size; }
+
+  /// Adds time spent in a scope to a counter, does nothing if counter is zero
+  class ScopedTimer {
+  public:
+    explicit ScopedTimer(Counter* counter, unsigned long long items = 0)
+      : _counter(counter), _items(items), _start(counter ? now() : 0) {}
+    ~ScopedTimer() { if (_counter) _counter->add(now() - _start, _items); }
+    void setItems(unsigned long long items) { _items = items; }
+  private:
+    Counter* _counter ;
+    unsigned long long _items ;
+    double _start ;
+  };
+
+protected:
+
+private:
+
+  Counter _total ;
+  unsigned long long _failures ;
+  Counter _phases[NPhases] ;
+  CounterMap _files ;
+  CounterMap _options ;
+  unsigned long long _strings ;
+  unsigned long long _stringBytes ;
+
+};
+
+} // namespace AppUtils
+
+#endif // APPUTILS_APPCMDPARSESTATS_H
@@ -15,11 +15,8 @@
 //---------------
 // C++ Headers --
 //---------------
-#include <cstdlib>
-#include <cerrno>
-#include <cmath>
-#include <limits.h>
-#include <float.h>
+#include <limits>
+#include <string>
 #include <boost/lexical_cast.hpp>
 
 //----------------------
@@ -68,6 +65,144 @@ struct DefaultAppCmdTypeTraitsToString {
   }
 };
 
+// Locale- and errno-free number parsing used by specializations below. Whole
+// range [begin, end) must be a valid number, leading blanks are allowed. Integer
+// syntax is the same as accepted by strtoull with base 0 (decimal, 0x-prefixed
+// hexadecimal, or 0-prefixed octal, with optional sign), floating point syntax
+// is the same as accepted by strtod. Functions return false if the range is not
+// a valid number or the number does not fit into the type.
+bool scanInteger(const char* begin, const char* end, bool& negative, unsigned long long& magnitude);
+bool strToFloat(const char* begin, const char* end, double& val);
+bool strToFloat(const char* begin, const char* end, float& val);
+
+template <typename T>
+bool strToSigned(const char* begin, const char* end, T& val) {
+  bool negative;
+  unsigned long long magnitude;
+  if (not scanInteger(begin, end, negative, magnitude)) return false;
+  const unsigned long long maxVal = std::numeric_limits<T>::max();
+  if (not negative) {
+    if (magnitude > maxVal) return false;
+    val = T(magnitude);
+  } else if (magnitude == 0) {
+    val = T(0);
+  } else {
+    // absolute value of minimum is one more than maximum
+    if (magnitude - 1 > maxVal) return false;
+    val = -T(magnitude - 1) - 1;
+  }
+  return true;
+}
+
+template <typename T>
+bool strToUnsigned(const char* begin, const char* end, T& val) {
+  bool negative;
+  unsigned long long magnitude;
+  if (not scanInteger(begin, end, negative, magnitude)) return false;
+  if (magnitude > std::numeric_limits<T>::max()) return false;
+  if (negative and magnitude != 0) {
+    // like strtoul negative numbers wrap around, but only for long types,
+    // shorter types are range-checked
+    if (sizeof(T) < sizeof(unsigned long)) return false;
+    val = T(0) - T(magnitude);
+  } else {
+    val = T(magnitude);
+  }
+  return true;
+}
+
+// Conversion of character range to number without making a string, defined
+// for all numeric types. AppCmdOptList uses it to convert lists in bulk.
+template <typename T>
+struct AppCmdFromChars {
+  enum { supported = false };
+};
+
+template <>
+struct AppCmdFromChars<long long> {
+  enum { supported = true };
+  static const char* typeName() { return "long long"; }
+  static bool convert(const char* begin, const char* end, long long& val) { return strToSigned(begin, end, val); }
+};
+
+template <>
+struct AppCmdFromChars<long> {
+  enum { supported = true };
+  static const char* typeName() { return "long"; }
+  static bool convert(const char* begin, const char* end, long& val) { return strToSigned(begin, end, val); }
+};
+
+template <>
+struct AppCmdFromChars<int> {
+  enum { supported = true };
+  static const char* typeName() { return "int"; }
+  static bool convert(const char* begin, const char* end, int& val) { return strToSigned(begin, end, val); }
+};
+
+template <>
+struct AppCmdFromChars<short> {
+  enum { supported = true };
+  static const char* typeName() { return "short"; }
+  static bool convert(const char* begin, const char* end, short& val) { return strToSigned(begin, end, val); }
+};
+
+template <>
+struct AppCmdFromChars<unsigned long long> {
+  enum { supported = true };
+  static const char* typeName() { return "unsigned long long"; }
+  static bool convert(const char* begin, const char* end, unsigned long long& val) { return strToUnsigned(begin, end, val); }
+};
+
+template <>
+struct AppCmdFromChars<unsigned long> {
+  enum { supported = true };
+  static const char* typeName() { return "unsigned long"; }
+  static bool convert(const char* begin, const char* end, unsigned long& val) { return strToUnsigned(begin, end, val); }
+};
+
+template <>
+struct AppCmdFromChars<unsigned int> {
+  enum { supported = true };
+  static const char* typeName() { return "unsigned int"; }
+  static bool convert(const char* begin, const char* end, unsigned int& val) { return strToUnsigned(begin, end, val); }
+};
+
+template <>
+struct AppCmdFromChars<unsigned short> {
+  enum { supported = true };
+  static const char* typeName() { return "unsigned short"; }
+  static bool convert(const char* begin, const char* end, unsigned short& val) { return strToUnsigned(begin, end, val); }
+};
+
+template <>
+struct AppCmdFromChars<double> {
+  enum { supported = true };
+  static const char* typeName() { return "double"; }
+  static bool convert(const char* begin, const char* end, double& val) { return strToFloat(begin, end, val); }
+};
+
+template <>
+struct AppCmdFromChars<float> {
+  enum { supported = true };
+  static const char* typeName() { return "float"; }
+  static bool convert(const char* begin, const char* end, float& val) { return strToFloat(begin, end, val); }
+};
+
+template <typename T>
+T numberFromString(const std::string& str) {
+  T val;
+  if (not AppCmdFromChars<T>::convert(str.data(), str.data() + str.size(), val)) {
+    throw AppCmdTypeCvtException(str, AppCmdFromChars<T>::typeName());
+  }
+  return val;
+}
+
+template <typename T>
+T charFromString(const std::string& str, const char* typeName) {
+  if (str.size() != 1) throw AppCmdTypeCvtException(str, typeName);
+  return T(str[0]);
+}
+
 } // namespace detail
 
 
@@ -83,6 +218,12 @@ struct DefaultAppCmdTypeTraitsToString {
  *  AppCmdOpt<T> should provide specialization for the AppCmdTypeTraits<T>
  *  struct.
  *
+ *  Specializations for built-in numeric types do not depend on locale and
+ *  do not use errno so they are safe to use from many threads. Integer types
+ *  accept decimal, hexadecimal (0x prefix) and octal (0 prefix) numbers like
+ *  strtol() with base 0, floating point types accept the same syntax as
+ *  strtod(). Character types accept exactly one character.
+ *
  *  This software was developed for the BaBar collaboration.  If you
  *  use all or part of it, please give an appropriate acknowledgement.
  *
@@ -101,22 +242,22 @@ struct AppCmdTypeTraits : detail::DefaultAppCmdTypeTraitsFromString<T>, detail::
 };
 
 /**
- *  Specialization for type long int
+ *  Specialization for type long long
+ */
+template<>
+struct AppCmdTypeTraits<long long> : detail::DefaultAppCmdTypeTraitsToString<long long> {
+  static long long fromString ( const std::string& str ) {
+    return detail::numberFromString<long long>( str ) ;
+  }
+};
+
+/**
+ *  Specialization for type long
  */
 template<>
 struct AppCmdTypeTraits<long> : detail::DefaultAppCmdTypeTraitsToString<long> {
   static long fromString ( const std::string& str ) {
-    const char* nptr = str.c_str() ;
-    char* end ;
-    errno = 0 ; // not thread-safe
-    long val = std::strtol ( nptr, &end, 0 ) ;
-    // conversion must consume all characters, otherwise it's not successful
-    // check errno also and value for overflow/underflow
-    if (end== nptr || *end != '\0' ||
-        ((errno == ERANGE && (val == LONG_MAX || val == LONG_MIN))) || (errno != 0 && val == 0)) {
-      throw AppCmdTypeCvtException ( str, "long" ) ;
-    }
-    return val ;
+    return detail::numberFromString<long>( str ) ;
   }
 };
 
@@ -126,12 +267,27 @@ struct AppCmdTypeTraits<long> : detail::DefaultAppCmdTypeTraitsToString<long> {
 template<>
 struct AppCmdTypeTraits<int> : detail::DefaultAppCmdTypeTraitsToString<int> {
   static int fromString ( const std::string& str ) {
-    try {
-      long res = AppCmdTypeTraits<long>::fromString( str ) ;
-      if ( res >= INT_MIN && res <= INT_MAX ) return int(res) ;
-    } catch (AppCmdTypeCvtException& e) {
-    }
-    throw AppCmdTypeCvtException ( str, "int" ) ;
+    return detail::numberFromString<int>( str ) ;
+  }
+};
+
+/**
+ *  Specialization for type short
+ */
+template<>
+struct AppCmdTypeTraits<short> : detail::DefaultAppCmdTypeTraitsToString<short> {
+  static short fromString ( const std::string& str ) {
+    return detail::numberFromString<short>( str ) ;
+  }
+};
+
+/**
+ *  Specialization for type unsigned long long
+ */
+template<>
+struct AppCmdTypeTraits<unsigned long long> : detail::DefaultAppCmdTypeTraitsToString<unsigned long long> {
+  static unsigned long long fromString ( const std::string& str ) {
+    return detail::numberFromString<unsigned long long>( str ) ;
   }
 };
 
@@ -141,17 +297,7 @@ struct AppCmdTypeTraits<int> : detail::DefaultAppCmdTypeTraitsToString<int> {
 template<>
 struct AppCmdTypeTraits<unsigned long> : detail::DefaultAppCmdTypeTraitsToString<unsigned long> {
   static unsigned long fromString ( const std::string& str ) {
-    const char* nptr = str.c_str() ;
-    char* end ;
-    errno = 0 ;
-    unsigned long val = std::strtoul ( nptr, &end, 0 ) ;
-    // conversion must consume all characters, otherwise it's not successful
-    // check errno also and value for overflow/underflow
-    if (end==nptr || *end != '\0' ||
-        ((errno==ERANGE && val==ULONG_MAX) || (errno!=0 && val==0))) {
-      throw AppCmdTypeCvtException ( str, "unsigned long" ) ;
-    }
-    return val ;
+    return detail::numberFromString<unsigned long>( str ) ;
   }
 };
 
@@ -161,13 +307,47 @@ struct AppCmdTypeTraits<unsigned long> : detail::DefaultAppCmdTypeTraitsToString
 template<>
 struct AppCmdTypeTraits<unsigned int> : detail::DefaultAppCmdTypeTraitsToString<unsigned int> {
   static unsigned int fromString ( const std::string& str ) {
-    try {
-      unsigned long res = AppCmdTypeTraits<unsigned long>::fromString( str ) ;
-      // check the range
-      if ( res <= UINT_MAX ) return (unsigned int)( res ) ;
-    } catch (AppCmdTypeCvtException& e) {
-    }
-    throw AppCmdTypeCvtException ( str, "unsigned int" ) ;
+    return detail::numberFromString<unsigned int>( str ) ;
+  }
+};
+
+/**
+ *  Specialization for type unsigned short
+ */
+template<>
+struct AppCmdTypeTraits<unsigned short> : detail::DefaultAppCmdTypeTraitsToString<unsigned short> {
+  static unsigned short fromString ( const std::string& str ) {
+    return detail::numberFromString<unsigned short>( str ) ;
+  }
+};
+
+/**
+ *  Specialization for type char
+ */
+template<>
+struct AppCmdTypeTraits<char> : detail::DefaultAppCmdTypeTraitsToString<char> {
+  static char fromString ( const std::string& str ) {
+    return detail::charFromString<char>( str, "char" ) ;
+  }
+};
+
+/**
+ *  Specialization for type signed char
+ */
+template<>
+struct AppCmdTypeTraits<signed char> : detail::DefaultAppCmdTypeTraitsToString<signed char> {
+  static signed char fromString ( const std::string& str ) {
+    return detail::charFromString<signed char>( str, "signed char" ) ;
+  }
+};
+
+/**
+ *  Specialization for type unsigned char
+ */
+template<>
+struct AppCmdTypeTraits<unsigned char> : detail::DefaultAppCmdTypeTraitsToString<unsigned char> {
+  static unsigned char fromString ( const std::string& str ) {
+    return detail::charFromString<unsigned char>( str, "unsigned char" ) ;
   }
 };
 
@@ -209,17 +389,7 @@ struct AppCmdTypeTraits<bool> {
 template<>
 struct AppCmdTypeTraits<double> : detail::DefaultAppCmdTypeTraitsToString<double> {
   static double fromString ( const std::string& str ) {
-    const char* nptr = str.c_str() ;
-    char* end ;
-    errno = 0;
-    double val = std::strtod ( nptr, &end ) ;
-    // conversion must consume all characters, otherwise it's not successful
-    // check errno also and value for overflow/underflow
-    if (end==nptr || *end != '\0' ||
-        ((errno == ERANGE && (val == HUGE_VAL || val == -HUGE_VAL))) || (errno != 0 && val == 0)) {
-      throw AppCmdTypeCvtException ( str, "double" ) ;
-    }
-    return val ;
+    return detail::numberFromString<double>( str ) ;
   }
 };
 
@@ -229,17 +399,7 @@ struct AppCmdTypeTraits<double> : detail::DefaultAppCmdTypeTraitsToString<double
 template<>
 struct AppCmdTypeTraits<float> : detail::DefaultAppCmdTypeTraitsToString<float> {
   static float fromString ( const std::string& str ) {
-    const char* nptr = str.c_str() ;
-    char* end ;
-    errno = 0;
-    float val = std::strtof ( nptr, &end ) ;
-    // conversion must consume all characters, otherwise it's not successful
-    // check errno also and value for overflow/underflow
-    if (end==nptr || *end != '\0' ||
-        ((errno == ERANGE && (val == HUGE_VALF || val == -HUGE_VALF))) || (errno != 0 && val == 0)) {
-      throw AppCmdTypeCvtException ( str, "float" ) ;
-    }
-    return val ;
+    return detail::numberFromString<float>( str ) ;
   }
 };
 
@@ -0,0 +1,130 @@
+#ifndef APPUTILS_APPDATAFILE_H
+#define APPUTILS_APPDATAFILE_H
+
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Class AppDataFile.
+//
+//------------------------------------------------------------------------
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include <cstddef>
+#include <string>
+#include <boost/shared_ptr.hpp>
+#include <boost/utility/string_ref.hpp>
+
+//----------------------
+// Base Class Headers --
+//----------------------
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+
+//------------------------------------
+// Collaborating Class Declarations --
+//------------------------------------
+
+//		---------------------
+// 		-- Class Interface --
+//		---------------------
+
+namespace AppUtils {
+
+/// @addtogroup AppUtils
+
+/**
+ *  @ingroup AppUtils
+ *
+ *  @brief Read-only contents of a data file found in $SIT_DATA.
+ *
+ *  File is located with AppDataPath and memory-mapped, its contents are
+ *  accessed directly in the mapped memory without copying. Mappings are
+ *  shared by the whole process: all instances (in any thread) which refer
+ *  to the same file (same canonical path) use one mapping, which is kept
+ *  while at least one instance refers to it. Several modules reading the
+ *  same large geometry or calibration file thus cost one mapping instead
+ *  of reading the file many times:
+ *
+ *  @code
+ *  AppDataFile file("Package/geometry.data");
+ *  if (not file.valid()) throw ...;
+ *  std::istringstream str(std::string(file.data(), file.size()));
+ *  @endcode
+ *
+ *  If the file changes on disk (modification time or size, or it is
+ *  replaced by another file) then new instances make new mapping, existing instances keep the old one. Old
+ *  mapping keeps old contents only if the file was replaced by writing a
+ *  new file and renaming it over the old one, which is how installed data
+ *  files must be updated. Mapping is shared with the file, so if the file
+ *  is rewritten in place existing instances see the contents change under
+ *  them, and if it is truncated then reading past the new end of file
+ *  kills the process with SIGBUS.
+ *
+ *  This class does not throw, if the file cannot be found (including
+ *  errors from AppDataPath) or mapped then valid() returns false and the
+ *  contents are empty.
+ *
+ *  Instances are cheap to copy, copies refer to the same mapping.
+ *
+ *  @note This software was developed for the LCLS project.  If you use all or
+ *  part of it, please give an appropriate acknowledgment.
+ *
+ *  @see AppDataPath
+ *
+ *  @version $Id$
+ *
+ *  @author Andy Salnikov
+ */
+
+class AppDataFile  {
+public:
+
+  /// Map file with the path relative to $SIT_DATA
+  explicit AppDataFile(const std::string& relPath) ;
+
+  /// Map file with the given path, not relative to $SIT_DATA
+  static AppDataFile open(const std::string& path) ;
+
+  /// Returns true if the file was found and mapped
+  bool valid() const { return bool(m_mapping); }
+
+  /// Returns canonical path of the mapped file or empty string
+  const std::string& path() const ;
+
+  /// Returns pointer to the file contents, never null
+  const char* data() const ;
+
+  /// Returns size of the file contents
+  size_t size() const ;
+
+  /// Returns file contents
+  boost::string_ref view() const { return boost::string_ref(data(), size()); }
+
+  /// Returns number of files currently mapped in this process
+  static unsigned long mappedFiles() ;
+
+protected:
+
+private:
+
+  class Mapping;
+
+  // make instance without mapping
+  AppDataFile() ;
+
+  // find or make mapping for the file
+  static boost::shared_ptr<const Mapping> map(const std::string& path) ;
+
+  boost::shared_ptr<const Mapping> m_mapping ;
+
+};
+
+} // namespace AppUtils
+
+#endif // APPUTILS_APPDATAFILE_H
@@ -14,6 +14,7 @@
 // C/C++ Headers --
 //-----------------
 #include <string>
+#include <vector>
 
 //----------------------
 // Base Class Headers --
@@ -42,6 +43,28 @@ namespace AppUtils {
  *  @brief This class represents a path to a file that can be found in
  *  one of the $SIT_DATA locations.
  *
+ *  Resolved paths are kept in a process-wide cache, so that every relative
+ *  path is looked up in $SIT_DATA directories only once per process, this
+ *  includes paths which were not found. Cache is thread-safe and is dropped
+ *  when the value of $SIT_DATA changes. Files which appear in $SIT_DATA after
+ *  they were looked up are not found until clearCache() is called.
+ *
+ *  Instead of checking existence of every candidate file, directories of
+ *  $SIT_DATA are read (when they are needed for the first time) and kept in
+ *  memory, so that many files from the same package directory cost one
+ *  directory listing instead of a metadata request per file and directory.
+ *  Directory contents are also only refreshed by clearCache().
+ *
+ *  $SIT_DATA directories which never change (e.g. installed releases) can
+ *  have a manifest, a file named manifestName in the directory, which lists
+ *  all files and sub-directories in it. Manifest is made when directory is
+ *  installed, e.g. with writeManifest() function from AppDataPath Python
+ *  module. First line of manifest is "AppDataPath-manifest 1", it is followed
+ *  by paths relative to the directory, one per line, sorted in byte order.
+ *  For directories with manifest the file system is not checked at all, the
+ *  manifest is memory-mapped and searched with binary search. Directories
+ *  without manifest (or with invalid manifest) are checked as usual.
+ *
  *  This software was developed for the LCLS project.  If you use all or 
  *  part of it, please give an appropriate acknowledgment.
  *
@@ -59,6 +82,40 @@ public:
   /// Returns path of the existing file or empty string
   const std::string& path() const { return m_path; }
 
+  /**
+   *  @brief Resolve many relative paths at once.
+   *
+   *  Gives the same results as making AppDataPath for each path but checks
+   *  all paths in one $SIT_DATA directory before going to the next one, and
+   *  does it in parallel threads, so that latencies of network file system
+   *  overlap instead of adding up. Results are also stored in the cache.
+   *
+   *  @param[in] relPaths  Relative paths.
+   *  @param[in] nThreads  Maximum number of threads, 0 means 16.
+   *  @return Paths of existing files or empty strings, in the same order as relPaths.
+   *  @throw boost::filesystem::filesystem_error for the first path which
+   *    cannot be checked, like the constructor does.
+   */
+  static std::vector<std::string> resolve(const std::vector<std::string>& relPaths, unsigned nThreads = 0);
+
+  /// Name of the manifest file in $SIT_DATA directories
+  static const char* const manifestName;
+
+  /// Counters of the process-wide cache of resolved paths
+  struct CacheStats {
+    CacheStats() : hits(0), misses(0), size(0), listings(0) {}
+    unsigned long long hits ;      ///< Number of lookups answered from cache
+    unsigned long long misses ;    ///< Number of lookups which checked $SIT_DATA directories
+    unsigned long size ;           ///< Number of paths in cache
+    unsigned long long listings ;  ///< Number of directories read
+  };
+
+  /// Returns counters of the process-wide cache
+  static CacheStats cacheStats();
+
+  /// Forget all resolved paths and reset counters
+  static void clearCache();
+
 protected:
 
 private:
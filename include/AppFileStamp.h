@@ -0,0 +1,92 @@
+#ifndef APPUTILS_APPFILESTAMP_H
+#define APPUTILS_APPFILESTAMP_H
+
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Class AppFileStamp.
+//
+//------------------------------------------------------------------------
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include <string>
+
+//----------------------
+// Base Class Headers --
+//----------------------
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+
+//------------------------------------
+// Collaborating Class Declarations --
+//------------------------------------
+struct stat;
+
+//		---------------------
+// 		-- Class Interface --
+//		---------------------
+
+namespace AppUtils {
+
+/// @addtogroup AppUtils
+
+/**
+ *  @ingroup AppUtils
+ *
+ *  @brief Identity, modification time and size of a file.
+ *
+ *  Used to detect changes of files (options files, data files) without
+ *  reading them. Two stamps of the same file compare equal if the file
+ *  was not modified in between. Device and inode are included so that a
+ *  file replaced by renaming another one over it is seen as changed even
+ *  if modification time and size were preserved.
+ *
+ *  @note This software was developed for the LCLS project.  If you use all or
+ *  part of it, please give an appropriate acknowledgment.
+ *
+ *  @see AppCmdOptFile
+ *  @see AppDataFile
+ *  @see AppFileWatcher
+ *
+ *  @version $Id$
+ *
+ *  @author Andy Salnikov
+ */
+
+struct AppFileStamp {
+
+  /// Make stamp of non-existing file
+  AppFileStamp() : dev(0), ino(0), mtime(0), mtimeNsec(0), size(0) {}
+
+  /// Make stamp from the result of stat()
+  explicit AppFileStamp(const struct stat& st) ;
+
+  /**
+   *  @brief Get stamp of a file without reading it.
+   *
+   *  @return false if the file does not exist or is not accessible.
+   */
+  static bool get(const std::string& path, AppFileStamp& stamp) ;
+
+  bool operator==(const AppFileStamp& other) const {
+    return dev == other.dev and ino == other.ino and mtime == other.mtime
+        and mtimeNsec == other.mtimeNsec and size == other.size;
+  }
+  bool operator!=(const AppFileStamp& other) const { return not (*this == other); }
+
+  unsigned long long dev;   ///< Device of the file system
+  unsigned long long ino;   ///< Inode number, changes when file is replaced
+  long mtime;               ///< Modification time, seconds
+  long mtimeNsec;           ///< Modification time, nanoseconds
+  unsigned long long size;  ///< File size
+};
+
+} // namespace AppUtils
+
+#endif // APPUTILS_APPFILESTAMP_H
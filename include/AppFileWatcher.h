@@ -0,0 +1,154 @@
+#ifndef APPUTILS_APPFILEWATCHER_H
+#define APPUTILS_APPFILEWATCHER_H
+
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Class AppFileWatcher.
+//
+//------------------------------------------------------------------------
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include <string>
+#include <vector>
+
+//----------------------
+// Base Class Headers --
+//----------------------
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+#include "AppUtils/AppFileStamp.h"
+
+//------------------------------------
+// Collaborating Class Declarations --
+//------------------------------------
+
+//		---------------------
+// 		-- Class Interface --
+//		---------------------
+
+namespace AppUtils {
+
+/// @addtogroup AppUtils
+
+/**
+ *  @ingroup AppUtils
+ *
+ *  @brief Watcher for changes in a set of files.
+ *
+ *  This class is used by AppBase to detect changes in options files, it can
+ *  be used for any other regular files as well. On Linux it uses inotify so
+ *  that waiting for changes does not access the file system at all, which is
+ *  important when thousands of processes watch files on a shared file system.
+ *  Directories containing the files are watched rather than files themselves
+ *  so that editors which replace files (write new file and rename it) are
+ *  handled correctly. Changes of symlink targets are not detected. On other
+ *  systems, or if inotify cannot be used, modification time and size of the
+ *  files are checked periodically instead.
+ *
+ *  Editors and tools usually make several changes in a quick succession
+ *  (truncate, write, rename). Watcher coalesces them: after the first change
+ *  it keeps collecting events until there are no new events for a given
+ *  interval and reports all changed files at once.
+ *
+ *  Watcher does not start any threads, application calls wait() when it is
+ *  ready to handle changes, or it can add fd() to its own poll()/select() loop.
+ *
+ *  @note This software was developed for the LCLS project.  If you use all or
+ *  part of it, please give an appropriate acknowledgment.
+ *
+ *  @see AppBase
+ *
+ *  @version $Id$
+ *
+ *  @author Andy Salnikov
+ */
+
+class AppFileWatcher  {
+public:
+
+  /**
+   *  @brief Make watcher with no files.
+   *
+   *  @param[in] coalesce  Interval in seconds without new events which ends a burst of changes.
+   */
+  explicit AppFileWatcher(double coalesce = 0.1) ;
+
+  // Destructor
+  ~AppFileWatcher() ;
+
+  /**
+   *  @brief Add file to the set of watched files.
+   *
+   *  File does not need to exist but its directory does.
+   *
+   *  @return false if the file cannot be watched.
+   */
+  bool watch(const std::string& path) ;
+
+  /// Stop watching all files
+  void clear() ;
+
+  /// Returns list of watched files
+  std::vector<std::string> files() const ;
+
+  /**
+   *  @brief Returns file descriptor which becomes readable when there are changes.
+   *
+   *  Returns -1 if inotify is not used, wait() has to be called periodically then.
+   */
+  int fd() const { return m_fd; }
+
+  /**
+   *  @brief Wait for changes in the watched files.
+   *
+   *  Waits until at least one file changes or timeout expires, after the first
+   *  change waits until burst of changes ends, but not longer than ten coalesce
+   *  intervals.
+   *
+   *  @param[in] timeout  Maximum time to wait for the first change in seconds, zero
+   *                      means to only check changes that happened already, negative
+   *                      means to wait indefinitely.
+   *  @return List of changed files in the order they were added, empty on timeout.
+   */
+  std::vector<std::string> wait(double timeout) ;
+
+protected:
+
+private:
+
+  struct File {
+    std::string path ;           // path as given to watch()
+    std::string name ;           // file name without directory
+    int wd ;                     // inotify watch descriptor of the directory
+    AppFileStamp stamp ;         // last known modification time and size, without inotify
+  };
+
+  // wait for events up to timeout seconds, returns true if any watched file changed
+  bool waitChanges(double timeout, std::vector<bool>& changed) ;
+
+  // read available inotify events, returns true if any watched file changed
+  bool readEvents(std::vector<bool>& changed) ;
+
+  // compare stamps of the files, returns true if any file changed
+  bool checkStamps(std::vector<bool>& changed) ;
+
+  double m_coalesce ;
+  int m_fd ;                   // inotify descriptor or -1
+  std::vector<File> m_files ;
+
+  // This class is non-copyable
+  AppFileWatcher(const AppFileWatcher&) ;
+  AppFileWatcher& operator=(const AppFileWatcher&) ;
+
+};
+
+} // namespace AppUtils
+
+#endif // APPUTILS_APPFILEWATCHER_H
@@ -0,0 +1,128 @@
+#ifndef APPUTILS_APPPREFETCH_H
+#define APPUTILS_APPPREFETCH_H
+
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Class AppPrefetch.
+//
+//------------------------------------------------------------------------
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/thread.hpp>
+
+//----------------------
+// Base Class Headers --
+//----------------------
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+
+//------------------------------------
+// Collaborating Class Declarations --
+//------------------------------------
+
+//		---------------------
+// 		-- Class Interface --
+//		---------------------
+
+namespace AppUtils {
+
+/// @addtogroup AppUtils
+
+/**
+ *  @ingroup AppUtils
+ *
+ *  @brief Reads files and resolves data paths in a background thread.
+ *
+ *  At startup applications spend most of the time waiting for the network
+ *  file system: opening options files and checking every $SIT_DATA directory
+ *  for data files. This class starts that work early in a separate thread so
+ *  that it overlaps with other initialization. Regular files are opened and
+ *  kernel is asked to read them ahead (posix_fadvise(WILLNEED)), so that later
+ *  reading finds data in the page cache. Data paths are resolved with
+ *  AppDataPath and the results are kept for dataPath().
+ *
+ *  All files and data paths have to be added before start() is called:
+ *
+ *  @code
+ *  AppPrefetch prefetch;
+ *  prefetch.addFile("job.cfg");
+ *  prefetch.addDataPath("Package/geometry.data");
+ *  prefetch.start();
+ *  // ... other initialization
+ *  std::string path = prefetch.dataPath("Package/geometry.data");
+ *  @endcode
+ *
+ *  Prefetching is only an optimization, errors (e.g. missing files) are
+ *  ignored and reported later by the code which actually reads the files.
+ *
+ *  @note This software was developed for the LCLS project.  If you use all or
+ *  part of it, please give an appropriate acknowledgment.
+ *
+ *  @see AppBase
+ *
+ *  @version $Id$
+ *
+ *  @author Andy Salnikov
+ */
+
+class AppPrefetch  {
+public:
+
+  /// Make prefetcher with no files
+  AppPrefetch() ;
+
+  /// Destructor waits for the background thread
+  ~AppPrefetch() ;
+
+  /// Add file to read ahead, must be called before start()
+  void addFile(const std::string& path) ;
+
+  /// Add path relative to $SIT_DATA to resolve, must be called before start()
+  void addDataPath(const std::string& relPath) ;
+
+  /// Start background thread, does nothing if it was started already
+  void start() ;
+
+  /// Wait until background thread finishes
+  void wait() ;
+
+  /**
+   *  @brief Returns path of the data file, same as AppDataPath(relPath).path().
+   *
+   *  For paths added with addDataPath() waits for the background thread and
+   *  returns its result, other paths are resolved in the calling thread.
+   */
+  std::string dataPath(const std::string& relPath) ;
+
+protected:
+
+private:
+
+  // body of the background thread
+  void run() ;
+
+  std::vector<std::string> m_files ;
+  std::vector<std::string> m_dataPaths ;
+  std::map<std::string, std::string> m_resolved ;  // filled by background thread
+  boost::scoped_ptr<boost::thread> m_thread ;
+
+  // This class is non-copyable
+  AppPrefetch(const AppPrefetch&) ;
+  AppPrefetch& operator=(const AppPrefetch&) ;
+
+};
+
+} // namespace AppUtils
+
+#endif // APPUTILS_APPPREFETCH_H
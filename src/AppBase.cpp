@@ -18,12 +18,16 @@
 //-----------------
 // C/C++ Headers --
 //-----------------
+#include <algorithm>
 #include <iostream>
 
 //-------------------------------
 // Collaborating Class Headers --
 //-------------------------------
 #include "AppUtils/AppCmdExceptions.h"
+#include "AppUtils/AppDataPath.h"
+#include "AppUtils/AppFileWatcher.h"
+#include "AppUtils/AppPrefetch.h"
 #include "MsgLogger/MsgLogger.h"
 #include "MsgLogger/MsgFormatter.h"
 #include "MsgLogger/MsgHandlerStdStreams.h"
@@ -63,6 +67,8 @@ AppBase::AppBase ( const std::string& appName )
   : _cmdline( ::fixAppName(appName) )
   , _optVerbose( _cmdline, "v,verbose", "verbose output, multiple allowed", 0 )
   , _optQuiet( _cmdline, "q,quiet", "quieter output, multiple allowed", 2 )
+  , _watcher()
+  , _prefetch()
 {
 }
 
@@ -79,6 +85,15 @@ AppBase::~AppBase ()
 int
 AppBase::run ( int argc, char** argv )
 {
+  // start reading files before they are needed
+  if ( _prefetch ) {
+    const std::vector<std::string>& files = _cmdline.optionsFilesInArgs ( argc, const_cast<const char**>(argv) ) ;
+    for ( std::vector<std::string>::const_iterator it = files.begin() ; it != files.end() ; ++ it ) {
+      _prefetch->addFile( *it ) ;
+    }
+    _prefetch->start() ;
+  }
+
   // parse command line, set all options and arguments
   try {
     _cmdline.parse ( argc, argv ) ;
@@ -178,6 +193,110 @@ AppBase::moreUsage ( std::ostream& out ) const
 {
 }
 
+/**
+ *  Enable reading of options files and data files at startup in background.
+ */
+void
+AppBase::enablePrefetch ( bool enable )
+{
+  if ( not enable ) {
+    _prefetch.reset() ;
+  } else if ( not _prefetch ) {
+    _prefetch.reset( new AppPrefetch() ) ;
+  }
+}
+
+/**
+ *  Add data file to resolve at startup if prefetch is enabled.
+ */
+void
+AppBase::prefetchDataPath ( const std::string& relPath )
+{
+  if ( _prefetch ) _prefetch->addDataPath( relPath ) ;
+}
+
+/**
+ *  Returns path of the data file.
+ */
+std::string
+AppBase::dataPath ( const std::string& relPath )
+{
+  if ( _prefetch ) return _prefetch->dataPath( relPath ) ;
+  return AppDataPath( relPath ).path() ;
+}
+
+/**
+ *  Start watching options files for changes.
+ */
+bool
+AppBase::watchOptionsFiles ( double coalesce )
+{
+  _watcher.reset( new AppFileWatcher( coalesce ) ) ;
+  return addWatchedFiles() ;
+}
+
+/**
+ *  Add options files read by parser to watcher, files watched already are skipped.
+ */
+bool
+AppBase::addWatchedFiles ()
+{
+  bool ok = true ;
+  const std::vector<std::string>& watched = _watcher->files() ;
+  const std::vector<std::string>& files = _cmdline.optionsFilesRead() ;
+  for ( std::vector<std::string>::const_iterator it = files.begin() ; it != files.end() ; ++ it ) {
+    if ( std::find( watched.begin(), watched.end(), *it ) != watched.end() ) continue ;
+    if ( not _watcher->watch( *it ) ) {
+      MsgLogRoot( warning, "cannot watch options file " << *it ) ;
+      ok = false ;
+    }
+  }
+  return ok ;
+}
+
+/**
+ *  Wait for changes in options files and apply them.
+ */
+int
+AppBase::checkOptionsFiles ( double timeout )
+{
+  if ( not _watcher ) return 0 ;
+
+  const std::vector<std::string>& files = _watcher->wait( timeout ) ;
+  if ( files.empty() ) return 0 ;
+
+  std::vector<AppCmdOptBase*> options ;
+  try {
+    options = _cmdline.reloadOptionsFiles() ;
+  } catch ( AppCmdException& e ) {
+    MsgLogRoot( error, "Error reading options files: " << e.what() ) ;
+    return -1 ;
+  }
+
+  // reloaded files may include new files
+  addWatchedFiles() ;
+
+  if ( not options.empty() ) this->optionsFilesChanged( options ) ;
+  return options.size() ;
+}
+
+/**
+ *  Returns file descriptor which becomes readable when options files change.
+ */
+int
+AppBase::optionsFilesFd () const
+{
+  return _watcher ? _watcher->fd() : -1 ;
+}
+
+/**
+ *  Method called after new values from options files are applied.
+ */
+void
+AppBase::optionsFilesChanged ( const std::vector<AppCmdOptBase*>& options )
+{
+}
+
 /**
  *  Method called before runApp, can be overridden in subclasses.
  *  Usually if you override it, call base class method too.
@@ -44,4 +44,20 @@ AppCmdArgBase::~AppCmdArgBase( )
 {
 }
 
+/// Reset value stored outside of argument to its default value.
+void
+AppCmdArgBase::resetValue( boost::any& value ) const
+{
+  throw AppCmdException("argument does not support external value storage: " + name());
+}
+
+/// Update value stored outside of argument.
+int
+AppCmdArgBase::updateValue ( StringList::const_iterator begin,
+                             StringList::const_iterator end,
+                             boost::any& value ) const
+{
+  throw AppCmdException("argument does not support external value storage: " + name());
+}
+
 } // namespace AppUtils
@@ -25,12 +25,17 @@
 // C++ Headers --
 //---------------
 #include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <functional>
 #include <iterator>
-#include <fstream>
 #include <iomanip>
-#include <set>
+#include <istream>
+#include <ostream>
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/thread.hpp>
 
 //-------------------------------
 // Collaborating Class Headers --
@@ -39,11 +44,14 @@
 #include "AppUtils/AppCmdExceptions.h"
 #include "AppUtils/AppCmdOptBase.h"
 #include "AppUtils/AppCmdOptBool.h"
+#include "AppUtils/AppCmdOptFile.h"
 #include "AppUtils/AppCmdOptList.h"
+#include "AppUtils/AppCmdParseResult.h"
 #include "AppUtils/AppCmdWordWrap.h"
 using std::ios;
 using std::ostream;
 using std::setw;
+namespace fs = boost::filesystem;
 
 //-----------------------------------------------------------------------
 // Local Macros, Typedefs, Structures, Unions and Forward Declarations --
@@ -52,7 +60,7 @@ using std::setw;
 namespace {
 
 bool
-isHelpOption(const std::string& optname)
+isHelpOption(boost::string_ref optname)
 {
   return optname == "help" or optname == "h" or optname == "?";
 }
@@ -60,6 +68,48 @@ isHelpOption(const std::string& optname)
 // special help option used internally
 AppUtils::AppCmdOptBool helpOpt("h,?,help", "print help message");
 
+// returns true if options file has include directives
+bool
+hasIncludes(const AppUtils::AppCmdOptFile::Entries& entries)
+{
+  for (AppUtils::AppCmdOptFile::Entries::const_iterator it = entries.begin(); it != entries.end(); ++it) {
+    if (it->name == AppUtils::AppCmdOptFile::includeDirective) return true;
+  }
+  return false;
+}
+
+// first word of the configuration snapshot and its format version
+const char snapshotMagic[] = "AppCmdSnapshot";
+const int snapshotVersion = 1;
+
+// write string prefixed with its length
+void
+writeString(std::ostream& out, const std::string& str)
+{
+  out << str.size() << ':' << str;
+}
+
+// read string written by writeString(), returns false on errors
+bool
+readString(std::istream& in, std::string& str)
+{
+  size_t size = 0;
+  char colon = 0;
+  if (not (in >> size >> colon) or colon != ':') return false;
+  str.resize(size);
+  if (size) in.read(&str[0], size);
+  return not in.fail();
+}
+
+// canonical path of existing file, empty string if file does not exist
+std::string
+canonicalPath(const std::string& path)
+{
+  boost::system::error_code ec;
+  const fs::path res = fs::canonical(path, ec);
+  return ec ? std::string() : res.string();
+}
+
 }
 
 //		----------------------------------------
@@ -77,10 +127,16 @@ AppCmdLine::AppCmdLine(const std::string& argv0)
     , _positionals()
     , _argv0(argv0)
     , _optionsFile(0)
-    , _argv()
-    , _helpWanted(false)
-    , _iter()
-    , _nWordsLeft(0)
+    , _optionsFileCache()
+    , _optionsFileThreads(0)
+    , _recordValues(false)
+    , _allOptions()
+    , _optIndex()
+    , _optionsFileIndex(-1)
+    , _compiled(false)
+    , _state()
+    , _stats(0)
+    , _statsMutex()
 {
   this->addOption(::helpOpt);
 }
@@ -94,9 +150,23 @@ AppCmdLine::~AppCmdLine()
 void
 AppCmdLine::addGroup(AppCmdOptGroup& group)
 {
+  if (_compiled) {
+    throw AppCmdException("parser is compiled, cannot add group: " + group.groupName());
+  }
   _groups.push_back(&group);
 }
 
+// Add one option to the parser.
+void
+AppCmdLine::addOption(AppCmdOptBase& option)
+{
+  if (_compiled) {
+    const std::vector<std::string>& optnames = option.options();
+    throw AppCmdException("parser is compiled, cannot add option: " + (optnames.empty() ? option.name() : optnames.back()));
+  }
+  AppCmdOptGroup::addOption(option);
+}
+
 /*
  *  Add one more positional argument. The argument supplied is not copied,
  *  only its address is remembered. The lifetime of the argument should extend
@@ -105,6 +175,9 @@ AppCmdLine::addGroup(AppCmdOptGroup& group)
 void
 AppCmdLine::addArgument(AppCmdArgBase& arg)
 {
+  if (_compiled) {
+    throw AppCmdException("parser is compiled, cannot add argument: " + arg.name());
+  }
   _positionals.push_back(&arg);
 }
 
@@ -117,6 +190,10 @@ AppCmdLine::addArgument(AppCmdArgBase& arg)
 void
 AppCmdLine::setOptionsFile(AppCmdOptList<std::string>& option)
 {
+  if (_compiled) {
+    throw AppCmdException("parser is compiled, cannot define options file option");
+  }
+
   // second attempt will fail
   if (_optionsFile) {
     throw AppCmdException("options file option already defined, cannot re-define");
@@ -126,6 +203,53 @@ AppCmdLine::setOptionsFile(AppCmdOptList<std::string>& option)
   _optionsFile = &option;
 }
 
+/*
+ *  Set directory for the options file cache.
+ */
+void
+AppCmdLine::setOptionsFileCache(const std::string& cacheDir)
+{
+  _optionsFileCache = cacheDir;
+}
+
+/*
+ *  Set number of threads used to read options files.
+ */
+void
+AppCmdLine::setOptionsFileThreads(unsigned nThreads)
+{
+  _optionsFileThreads = nThreads;
+}
+
+/*
+ *  Enable recording of option values for saveSnapshot().
+ */
+void
+AppCmdLine::setRecordValues(bool enable)
+{
+  _recordValues = enable;
+}
+
+/*
+ *  Set object which receives parsing statistics.
+ */
+void
+AppCmdLine::setParseStats(AppCmdParseStats* stats)
+{
+  _stats = stats;
+}
+
+/*
+ *  Freeze parser definition, check and index all options and arguments.
+ */
+void
+AppCmdLine::compile()
+{
+  if (_compiled) return;
+  buildSchema();
+  _compiled = true;
+}
+
 /*
  *  Parse function examines command line and sets the corresponding arguments.
  *  If it returns false then you should not expect anything, just exit.
@@ -133,20 +257,456 @@ AppCmdLine::setOptionsFile(AppCmdOptList<std::string>& option)
 void
 AppCmdLine::parse(int argc, char* argv[])
 {
-  _argv.clear();
-  _argv.insert(_argv.end(), argv + 1, argv + argc);
-
-  doParse();
+  parse(argc, const_cast<const char**>(argv));
 }
 void
 AppCmdLine::parse(int argc, const char* argv[])
 {
-  _argv.clear();
-  _argv.insert(_argv.end(), argv + 1, argv + argc);
+  // copy all words into single buffer
+  size_t size = 0;
+  for (int i = 1; i < argc; ++ i) {
+    size += std::strlen(argv[i]);
+  }
+  clearWords(_state);
+  _state.argvBuf.reserve(size);
+  _state.wordEnds.reserve(argc);
+  for (int i = 1; i < argc; ++ i) {
+    appendWord(_state, argv[i]);
+  }
 
   doParse();
 }
 
+/*
+ *  Find names of options files in command line without parsing it.
+ */
+std::vector<std::string>
+AppCmdLine::optionsFilesInArgs(int argc, const char* argv[]) const
+{
+  std::vector<std::string> files;
+  if (not _optionsFile) return files;
+
+  // option splits its arguments itself
+  const AppCmdOptBase* option = _optionsFile;
+  boost::any value;
+  option->resetValue(value);
+
+  const std::vector<std::string>& names = _optionsFile->options();
+  for (int i = 1; i < argc; ++ i) {
+    const std::string word(argv[i]);
+    if (word == "--") break;
+
+    for (std::vector<std::string>::const_iterator it = names.begin(); it != names.end(); ++ it) {
+      const std::string opt = (it->size() == 1 ? "-" : "--") + *it;
+      if (word == opt) {
+        // argument in the next word
+        if (i + 1 < argc) option->updateValue(argv[++ i], value);
+        break;
+      }
+      const std::string prefix = it->size() == 1 ? opt : opt + "=";
+      if (word.size() > prefix.size() and word.compare(0, prefix.size(), prefix) == 0) {
+        option->updateValue(word.substr(prefix.size()), value);
+        break;
+      }
+    }
+  }
+
+  // empty name ends the list like in parseOptionsFile()
+  const std::vector<std::string>& all = boost::any_cast<const std::vector<std::string>&>(value);
+  files.assign(all.begin(), std::find(all.begin(), all.end(), std::string()));
+  return files;
+}
+
+/*
+ *  Parse command line and store values in the result object.
+ */
+void
+AppCmdLine::parse(int argc, char* argv[], AppCmdParseResult& result) const
+{
+  parse(argc, const_cast<const char**>(argv), result);
+}
+void
+AppCmdLine::parse(int argc, const char* argv[], AppCmdParseResult& result) const
+{
+  ParseState state;
+  for (int i = 1; i < argc; ++ i) {
+    appendWord(state, argv[i]);
+  }
+  doParse(state, result);
+}
+
+/*
+ *  Convert arguments of all options with lazy conversion.
+ */
+void
+AppCmdLine::validate() const
+{
+  for (OptionsList::const_iterator it = _allOptions.begin(); it != _allOptions.end(); ++ it) {
+    (*it)->validate();
+  }
+}
+
+/*
+ *  Re-read options files which changed since last parse().
+ */
+std::vector<AppCmdOptBase*>
+AppCmdLine::reloadOptionsFiles()
+{
+  std::vector<AppCmdOptBase*> changed;
+
+  // read files which changed, new contents is only kept for files with different entries
+  const size_t nFiles = _state.optFiles.size();
+  std::vector<OptFileRecord> newFiles(nFiles);
+  std::vector<bool> fileChanged(nFiles, false);
+  bool anyChanged = false;
+  for (size_t i = 0; i != nFiles; ++ i) {
+    OptFileRecord& record = _state.optFiles[i];
+    if (not optionsFileChanged(record)) continue;
+
+    readOptionsFile(record.path, newFiles[i]);
+    if (newFiles[i].entries == record.entries) {
+      // only touched, keep new stamps to not check it next time
+      std::swap(record, newFiles[i]);
+      newFiles[i] = OptFileRecord();
+    } else {
+      fileChanged[i] = true;
+      anyChanged = true;
+    }
+  }
+  if (not anyChanged) return changed;
+
+  // options which appear in old or new contents of changed files
+  const size_t nOptions = _allOptions.size();
+  std::vector<bool> affected(nOptions, false);
+  for (size_t i = 0; i != nFiles; ++ i) {
+    if (not fileChanged[i]) continue;
+    const OptFileRecord* records[] = { &_state.optFiles[i], &newFiles[i] };
+    for (int r = 0; r != 2; ++ r) {
+      for (size_t e = 0; e != records[r]->entries.size(); ++ e) {
+        const size_t optIndex = records[r]->entries[e].first;
+        if (not _state.cmdlineOptions[optIndex]) affected[optIndex] = true;
+      }
+    }
+  }
+
+  // old and new sequences of values for affected options from all files
+  typedef std::vector<const std::string*> ValueRefs;
+  std::vector<ValueRefs> oldValues(nOptions);
+  std::vector<ValueRefs> newValues(nOptions);
+  std::vector<ValueRefs> newPaths(nOptions);
+  std::vector< std::vector<unsigned> > newLines(nOptions);
+  for (size_t i = 0; i != nFiles; ++ i) {
+    const OptFileRecord& oldRecord = _state.optFiles[i];
+    const OptFileRecord& newRecord = fileChanged[i] ? newFiles[i] : oldRecord;
+    for (size_t e = 0; e != oldRecord.entries.size(); ++ e) {
+      const size_t optIndex = oldRecord.entries[e].first;
+      if (affected[optIndex]) oldValues[optIndex].push_back(&oldRecord.entries[e].second);
+    }
+    for (size_t e = 0; e != newRecord.entries.size(); ++ e) {
+      const size_t optIndex = newRecord.entries[e].first;
+      if (affected[optIndex]) {
+        newValues[optIndex].push_back(&newRecord.entries[e].second);
+        const std::pair<unsigned, unsigned>& origin = newRecord.origins[e];
+        newPaths[optIndex].push_back(&newRecord.originFiles[origin.first]);
+        newLines[optIndex].push_back(origin.second);
+      }
+    }
+  }
+
+  // find options whose values changed and convert their new values first,
+  // nothing is modified until all values are converted successfully
+  std::vector<size_t> changedIndices;
+  std::vector<bool> isChanged(nOptions, false);
+  for (size_t optIndex = 0; optIndex != nOptions; ++ optIndex) {
+    if (not affected[optIndex]) continue;
+    const ValueRefs& oldRefs = oldValues[optIndex];
+    const ValueRefs& newRefs = newValues[optIndex];
+    bool same = oldRefs.size() == newRefs.size();
+    for (size_t v = 0; same and v != oldRefs.size(); ++ v) {
+      same = *oldRefs[v] == *newRefs[v];
+    }
+    if (same) continue;
+
+    const AppCmdOptBase* option = _allOptions[optIndex];
+    boost::any value;
+    option->resetValue(value);
+    for (ValueRefs::const_iterator it = newRefs.begin(); it != newRefs.end(); ++ it) {
+      // this may throw
+      option->updateValue(**it, value);
+    }
+    changedIndices.push_back(optIndex);
+    isChanged[optIndex] = true;
+  }
+
+  // all values are good, set them in options
+  for (std::vector<size_t>::const_iterator idx = changedIndices.begin(); idx != changedIndices.end(); ++ idx) {
+    const size_t optIndex = *idx;
+    const ValueRefs& newRefs = newValues[optIndex];
+    AppCmdOptBase* option = _allOptions[optIndex];
+    option->reset();
+    for (ValueRefs::const_iterator it = newRefs.begin(); it != newRefs.end(); ++ it) {
+      option->setValue(**it);
+    }
+    changed.push_back(option);
+
+    SourceEntry& entry = _state.sources[optIndex];
+    entry = SourceEntry();
+    if (not newRefs.empty()) {
+      entry.source = Provenance::OptionsFile;
+      entry.fileIndex = sourceFileIndex(_state, *newPaths[optIndex].back());
+      entry.line = newLines[optIndex].back();
+      entry.count = newRefs.size();
+    }
+  }
+
+  // replace recorded values of changed options
+  if (_state.recordValues and not changedIndices.empty()) {
+    std::vector<ValueRecord> values;
+    values.reserve(_state.values.size());
+    for (std::vector<ValueRecord>::const_iterator it = _state.values.begin(); it != _state.values.end(); ++ it) {
+      if (not isChanged[it->optIndex]) values.push_back(*it);
+    }
+    for (std::vector<size_t>::const_iterator idx = changedIndices.begin(); idx != changedIndices.end(); ++ idx) {
+      const ValueRefs& newRefs = newValues[*idx];
+      for (size_t v = 0; v != newRefs.size(); ++ v) {
+        values.push_back(ValueRecord());
+        values.back().optIndex = *idx;
+        values.back().value = *newRefs[v];
+        values.back().source = "file:" + *newPaths[*idx][v] + ":" + boost::lexical_cast<std::string>(newLines[*idx][v]);
+      }
+    }
+    _state.values.swap(values);
+  }
+
+  // everything is applied, remember new contents
+  for (size_t i = 0; i != nFiles; ++ i) {
+    if (fileChanged[i]) std::swap(_state.optFiles[i], newFiles[i]);
+  }
+
+  return changed;
+}
+
+/*
+ *  Save resolved configuration of the last parse().
+ */
+void
+AppCmdLine::saveSnapshot(std::ostream& out) const
+{
+  if (not _state.recordValues) {
+    throw AppCmdException("option values were not recorded, call setRecordValues() before parse()");
+  }
+
+  out << ::snapshotMagic << ' ' << ::snapshotVersion << '\n';
+
+  // values in the order they were given
+  std::vector<bool> given(_allOptions.size(), false);
+  for (std::vector<ValueRecord>::const_iterator it = _state.values.begin(); it != _state.values.end(); ++ it) {
+    given[it->optIndex] = true;
+    out << "opt " << _allOptions[it->optIndex]->options().back() << ' ';
+    ::writeString(out, it->source);
+    out << ' ';
+    ::writeString(out, it->value);
+    out << '\n';
+  }
+
+  // options with default values, for information only
+  for (OptionsList::size_type i = 0; i != _allOptions.size(); ++ i) {
+    if (not given[i]) out << "def " << _allOptions[i]->options().back() << '\n';
+  }
+
+  for (StringList::const_iterator it = _state.args.begin(); it != _state.args.end(); ++ it) {
+    out << "arg ";
+    ::writeString(out, *it);
+    out << '\n';
+  }
+
+  if (not out) throw AppCmdException("failed to write configuration snapshot");
+}
+
+/*
+ *  Set options and arguments from the snapshot made by saveSnapshot().
+ */
+void
+AppCmdLine::loadSnapshot(std::istream& in)
+{
+  if (not _compiled) {
+    buildSchema();
+  } else {
+    checkSchema();
+  }
+
+  std::string magic;
+  int version = 0;
+  in >> magic >> version;
+  if (magic != ::snapshotMagic or version != ::snapshotVersion) {
+    throw AppCmdException("not a configuration snapshot or unsupported snapshot version");
+  }
+
+  // read everything before changing options
+  std::vector<ValueRecord> values;
+  StringList args;
+  std::string kind;
+  while (in >> kind) {
+    if (kind == "arg") {
+      args.push_back(std::string());
+      if (not ::readString(in, args.back())) throw AppCmdException("configuration snapshot: failed to read argument");
+      continue;
+    }
+
+    std::string name;
+    in >> name;
+    const int optIndex = findOptIndex(WordRef(name));
+    if (optIndex < 0) {
+      throw AppCmdException("configuration snapshot: option '" + name + "' is unknown");
+    }
+    if (kind == "opt") {
+      values.push_back(ValueRecord());
+      ValueRecord& record = values.back();
+      record.optIndex = optIndex;
+      if (not ::readString(in, record.source) or not ::readString(in, record.value)) {
+        throw AppCmdException("configuration snapshot: failed to read value of option '" + name + "'");
+      }
+    } else if (kind != "def") {
+      throw AppCmdException("configuration snapshot: unexpected record '" + kind + "'");
+    }
+  }
+  if (in.bad()) throw AppCmdException("failed to read configuration snapshot");
+
+  // give values to options in the same order as original parse did
+  std::for_each(_allOptions.begin(), _allOptions.end(), std::mem_fun(&AppCmdOptBase::reset));
+  std::for_each(_positionals.begin(), _positionals.end(), std::mem_fun(&AppCmdArgBase::reset));
+  _state.helpWanted = false;
+  _state.optFiles.clear();
+  _state.cmdlineOptions.clear();
+  _state.recordValues = true;
+  _state.values.swap(values);
+  _state.args.swap(args);
+  _state.sources.assign(_allOptions.size(), SourceEntry());
+  _state.sourceFiles.clear();
+  for (std::vector<ValueRecord>::const_iterator it = _state.values.begin(); it != _state.values.end(); ++ it) {
+    // this may throw
+    _allOptions[it->optIndex]->setValue(it->value);
+
+    // sources are restored from their names, "cmdline:N", "file:PATH:LINE" or "file:PATH"
+    SourceEntry& entry = _state.sources[it->optIndex];
+    const unsigned count = entry.count + 1;
+    entry = SourceEntry();
+    entry.count = count;
+    if (it->source.compare(0, 8, "cmdline:") == 0) {
+      entry.source = Provenance::CommandLine;
+      entry.word = std::strtoul(it->source.c_str() + 8, 0, 10);
+    } else if (it->source.compare(0, 5, "file:") == 0) {
+      entry.source = Provenance::OptionsFile;
+      std::string path = it->source.substr(5);
+      const std::string::size_type pos = path.rfind(':');
+      if (pos != std::string::npos and pos + 1 < path.size()) {
+        char* end = 0;
+        const unsigned long line = std::strtoul(path.c_str() + pos + 1, &end, 10);
+        if (*end == '\0') {
+          entry.line = line;
+          path.erase(pos);
+        }
+      }
+      entry.fileIndex = sourceFileIndex(_state, path);
+    }
+  }
+  assignArgs(_state);
+}
+
+/*
+ *  Get the source of the option value.
+ */
+AppCmdLine::Provenance
+AppCmdLine::provenance(const AppCmdOptBase& option) const
+{
+  const int optIndex = findOptIndex(&option);
+  if (optIndex < 0) throw AppCmdException("provenance: option is not known to the parser");
+
+  Provenance res;
+  if (size_t(optIndex) >= _state.sources.size()) return res;
+  const SourceEntry& entry = _state.sources[optIndex];
+  res.source = entry.source;
+  res.word = entry.word;
+  if (entry.source == Provenance::OptionsFile) res.file = _state.sourceFiles[entry.fileIndex];
+  res.line = entry.line;
+  res.count = entry.count;
+  return res;
+}
+
+/*
+ *  Print sources of all option values.
+ */
+void
+AppCmdLine::dumpProvenance(std::ostream& out) const
+{
+  for (OptionsList::size_type i = 0; i != _allOptions.size(); ++ i) {
+    out << _allOptions[i]->options().back() << ' ';
+    const SourceEntry entry = i < _state.sources.size() ? _state.sources[i] : SourceEntry();
+    switch (entry.source) {
+    case Provenance::Default:
+      out << "default";
+      break;
+    case Provenance::CommandLine:
+      out << "cmdline:" << entry.word;
+      break;
+    case Provenance::OptionsFile:
+      out << "file:" << _state.sourceFiles[entry.fileIndex];
+      if (entry.line) out << ':' << entry.line;
+      break;
+    }
+    if (entry.count > 1) out << " (" << entry.count << " values)";
+    out << '\n';
+  }
+}
+
+/*
+ *  Get the names of options files read by the last parse().
+ */
+std::vector<std::string>
+AppCmdLine::optionsFilesRead() const
+{
+  std::vector<std::string> files;
+  for (std::vector<OptFileRecord>::const_iterator it = _state.optFiles.begin(); it != _state.optFiles.end(); ++ it) {
+    files.push_back(it->path);
+    for (size_t i = 0; i != it->includes.size(); ++ i) {
+      if (std::find(files.begin(), files.end(), it->includes[i].first) == files.end()) {
+        files.push_back(it->includes[i].first);
+      }
+    }
+  }
+  return files;
+}
+
+/*
+ *  Parse many command lines in parallel.
+ */
+AppCmdLine::BatchResults
+AppCmdLine::parseBatch(const std::vector<StringList>& cmdlines, unsigned nThreads)
+{
+  // parser must not change while threads are running
+  compile();
+  checkSchema();
+
+  BatchResults results(cmdlines.size());
+
+  if (nThreads == 0) nThreads = boost::thread::hardware_concurrency();
+  if (nThreads > cmdlines.size()) nThreads = cmdlines.size();
+
+  if (nThreads <= 1) {
+    parseBatchRange(cmdlines, results, 0, 1);
+  } else {
+    // each thread takes every nThreads-th command line
+    boost::thread_group threads;
+    for (unsigned i = 0; i != nThreads; ++ i) {
+      threads.create_thread(boost::bind(&AppCmdLine::parseBatchRange, this,
+          boost::cref(cmdlines), boost::ref(results), i, nThreads));
+    }
+    threads.join_all();
+  }
+
+  return results;
+}
+
 /*
  *  Returns true if the "help" option was specified on the command line.
  *  Always check its return value after calling parse() when it returns true,
@@ -155,7 +715,7 @@ AppCmdLine::parse(int argc, const char* argv[])
 bool
 AppCmdLine::helpWanted() const
 {
-  return _helpWanted;
+  return _state.helpWanted;
 }
 
 /*
@@ -167,11 +727,8 @@ AppCmdLine::usage(std::ostream& out) const
   out.setf(ios::left, ios::adjustfield);
 
   // build full list of options from all groups
-  OptionsList options = this->options();
-  for (GroupsList::const_iterator git = _groups.begin(); git != _groups.end(); ++ git) {
-    const OptionsList& groupOptions = (*git)->options();
-    options.insert(options.end(), groupOptions.begin(), groupOptions.end());
-  }
+  OptionsList options;
+  allOptions(options);
 
   out << "\nUsage: " << _argv0;
   if (!options.empty()) {
@@ -255,55 +812,78 @@ std::string
 AppCmdLine::cmdline() const
 {
   std::string cmdl = _argv0;
-  for (StringList::const_iterator i = _argv.begin(); i != _argv.end(); ++i) {
-    const std::string& arg = *i;
-    if (arg.find_first_of(" \t\n\"") != std::string::npos) {
+  for (WordList::const_iterator i = _state.words.begin(); i != _state.words.end(); ++i) {
+    const WordRef& arg = *i;
+    if (arg.find_first_of(" \t\n\"") != WordRef::npos) {
       cmdl += " '";
-      cmdl += arg;
+      cmdl.append(arg.data(), arg.size());
       cmdl += "'";
     } else {
       cmdl += " ";
-      cmdl += arg;
+      cmdl.append(arg.data(), arg.size());
     }
   }
   return cmdl;
 }
 
-/// real parsing happens in this method
+/// clear command line buffer
 void
-AppCmdLine::doParse()
+AppCmdLine::clearWords(ParseState& state)
 {
-  _helpWanted = 0;
+  state.argvBuf.clear();
+  state.wordEnds.clear();
+}
 
-  // build full list of options from all groups
-  OptionsList options = this->options();
-  for (GroupsList::const_iterator git = _groups.begin(); git != _groups.end(); ++ git) {
-    const OptionsList& groupOptions = (*git)->options();
-    options.insert(options.end(), groupOptions.begin(), groupOptions.end());
+/// append one word to the command line buffer, words may contain any bytes including '\0'
+void
+AppCmdLine::appendWord(ParseState& state, const char* word)
+{
+  state.argvBuf.append(word);
+  state.wordEnds.push_back(state.argvBuf.size());
+}
+
+void
+AppCmdLine::appendWord(ParseState& state, const std::string& word)
+{
+  state.argvBuf.append(word);
+  state.wordEnds.push_back(state.argvBuf.size());
+}
+
+/// split command line buffer into words, words refer to the buffer and are not copied
+void
+AppCmdLine::splitWords(ParseState& state)
+{
+  state.words.clear();
+  const char* const data = state.argvBuf.data();
+  size_t begin = 0;
+  for (std::vector<size_t>::const_iterator it = state.wordEnds.begin(); it != state.wordEnds.end(); ++ it) {
+    state.words.push_back(WordRef(data + begin, *it - begin));
+    begin = *it;
   }
+}
+
+/// collect all options and arguments, check them for consistency and build index
+void
+AppCmdLine::buildSchema()
+{
+  // build full list of options from all groups
+  allOptions(_allOptions);
 
   // if options-file option was set but it was not added to any group add it now to the parser
   if (_optionsFile) {
-    if (std::find(options.begin(), options.end(), _optionsFile) == options.end()) {
+    if (std::find(_allOptions.begin(), _allOptions.end(), _optionsFile) == _allOptions.end()) {
       // define a regular option
       this->addOption(*_optionsFile);
-      options.push_back(_optionsFile);
+      _allOptions.push_back(_optionsFile);
     }
   }
 
-  // check for option name conflicts
-  std::set<std::string> allNames;
-  for (OptionsList::const_iterator oit = options.begin(); oit != options.end(); ++ oit) {
-    const std::vector<std::string>& optnames = (*oit)->options();
-    for (std::vector<std::string>::const_iterator it = optnames.begin(); it != optnames.end(); ++it) {
-      if (allNames.count(*it)) {
-        throw AppCmdOptDefinedException(*it);
-      }
-      allNames.insert(*it);
-    }
+  // index all option names, this also checks for option name conflicts
+  buildIndex(_allOptions);
+  _optionsFileIndex = -1;
+  if (_optionsFile) {
+    _optionsFileIndex = std::find(_allOptions.begin(), _allOptions.end(), _optionsFile) - _allOptions.begin();
   }
-  allNames.clear();
-
 
   // check for arguments order
   for (PositionalsList::const_iterator it = _positionals.begin(); it != _positionals.end(); ++ it) {
@@ -320,137 +900,278 @@ AppCmdLine::doParse()
 
     }
   }
+}
+
+/// check that compiled parser was not modified
+void
+AppCmdLine::checkSchema() const
+{
+  // options cannot be added to parser after compilation but can be
+  // added to groups directly, check that number of options is the same
+  size_t nOptions = this->options().size();
+  for (GroupsList::const_iterator git = _groups.begin(); git != _groups.end(); ++ git) {
+    nOptions += (*git)->options().size();
+  }
+  if (nOptions != _allOptions.size()) {
+    throw AppCmdException("options were added to option group after parser was compiled");
+  }
+}
+
+/// real parsing happens in this method
+void
+AppCmdLine::doParse()
+{
+  if (not _compiled) {
+    // options may have been added since last call
+    buildSchema();
+  } else {
+    checkSchema();
+  }
+
+  _state.optFiles.clear();
+  _state.recordValues = _recordValues;
+  _state.values.clear();
+  doParse(_state);
+}
+
+/// parse command line words from state into result object, parser must be compiled
+void
+AppCmdLine::doParse(ParseState& state, AppCmdParseResult& result) const
+{
+  if (not _compiled) {
+    throw AppCmdException("parser must be compiled before parsing into AppCmdParseResult");
+  }
+  checkSchema();
+
+  state.result = &result;
+  doParse(state);
+}
+
+/// parse command line words from state
+void
+AppCmdLine::doParse(ParseState& state) const
+{
+  if (not _stats) {
+    state.stats = 0;
+    parseWords(state);
+    return;
+  }
+
+  // collect statistics of this call locally, merge them when done
+  AppCmdParseStats stats;
+  state.stats = &stats;
+  state.optStats.assign(_allOptions.size(), AppCmdParseStats::Counter());
+  const double start = AppCmdParseStats::now();
+  try {
+    parseWords(state);
+  } catch (...) {
+    mergeStats(state, start, false);
+    throw;
+  }
+  mergeStats(state, start, true);
+}
+
+/// parse command line words from state, phases are timed if statistics is enabled
+void
+AppCmdLine::parseWords(ParseState& state) const
+{
+  state.helpWanted = false;
+
+  {
+    AppCmdParseStats::ScopedTimer timer(state.stats ? &state.stats->phase(AppCmdParseStats::Split) : 0);
+    splitWords(state);
+    timer.setItems(state.words.size());
+    if (state.stats) state.stats->addBytes(state.argvBuf.size());
+  }
 
   // reset all options and arguments to their default values
-  std::for_each(options.begin(), options.end(), std::mem_fun(&AppCmdOptBase::reset));
-  std::for_each(_positionals.begin(), _positionals.end(), std::mem_fun(&AppCmdArgBase::reset));
+  {
+    AppCmdParseStats::ScopedTimer timer(state.stats ? &state.stats->phase(AppCmdParseStats::Reset) : 0,
+        _allOptions.size() + _positionals.size());
+    if (AppCmdParseResult* result = state.result) {
+      result->_parser = this;
+      result->_helpWanted = false;
+      result->_options.resize(_allOptions.size());
+      result->_optionsChanged.assign(_allOptions.size(), false);
+      for (OptionsList::size_type i = 0; i != _allOptions.size(); ++ i) {
+        _allOptions[i]->resetValue(result->_options[i]);
+      }
+      result->_args.resize(_positionals.size());
+      for (PositionalsList::size_type i = 0; i != _positionals.size(); ++ i) {
+        _positionals[i]->resetValue(result->_args[i]);
+      }
+    } else {
+      std::for_each(_allOptions.begin(), _allOptions.end(), std::mem_fun(&AppCmdOptBase::reset));
+      std::for_each(_positionals.begin(), _positionals.end(), std::mem_fun(&AppCmdArgBase::reset));
+      state.sources.assign(_allOptions.size(), SourceEntry());
+      state.sourceFiles.clear();
+    }
+  }
 
   // get options from command line
-  parseOptions(options);
-  if (_helpWanted) {
+  {
+    AppCmdParseStats::ScopedTimer timer(state.stats ? &state.stats->phase(AppCmdParseStats::Options) : 0);
+    parseOptions(state);
+    timer.setItems(state.iter - state.words.begin());
+  }
+  if (state.helpWanted) {
+    if (state.result) state.result->_helpWanted = true;
     return;
   }
 
   // get options from an options file if any
-  parseOptionsFile(options);
+  {
+    AppCmdParseStats::ScopedTimer timer(state.stats ? &state.stats->phase(AppCmdParseStats::OptionsFile) : 0);
+    parseOptionsFile(state);
+  }
 
   // get remaining args
-  parseArgs();
+  {
+    AppCmdParseStats::ScopedTimer timer(state.stats ? &state.stats->phase(AppCmdParseStats::Args) : 0,
+        state.words.end() - state.iter);
+    parseArgs(state);
+  }
+}
+
+/// add statistics of one parse() call to the statistics object
+void
+AppCmdLine::mergeStats(ParseState& state, double start, bool ok) const
+{
+  AppCmdParseStats& stats = *state.stats;
+  stats.total().add(AppCmdParseStats::now() - start, state.words.size());
+  if (not ok) stats.addFailure();
+  for (OptionsList::size_type i = 0; i != state.optStats.size(); ++ i) {
+    if (state.optStats[i].count) {
+      stats.option(_allOptions[i]->options().back()).merge(state.optStats[i]);
+    }
+  }
+  state.stats = 0;
+
+  boost::mutex::scoped_lock lock(_statsMutex);
+  if (_stats) _stats->merge(stats);
 }
 
 /// parse options
 void
-AppCmdLine::parseOptions(const OptionsList& options)
+AppCmdLine::parseOptions(ParseState& state) const
 {
-  _iter = _argv.begin();
-  _nWordsLeft = _argv.size();
-  while (_iter != _argv.end()) {
+  // words are not copied, strings are only made for option values
+  state.iter = state.words.begin();
+  while (state.iter != state.words.end()) {
 
-    const std::string& word = *_iter;
+    const WordRef word = *state.iter;
+    const ValueSource source(state.iter - state.words.begin() + 1);
 
     if (word == "--") {
 
       // should stop here
-      ++_iter;
+      ++state.iter;
       break;
 
     } else if (word.size() > 2 && word[0] == '-' && word[1] == '-') {
 
       // long option takes everything before '='
-      const std::string optname(word, 2, word.find('=') - 2);
+      const WordRef::size_type eqpos = word.find('=');
+      const WordRef optname = word.substr(2, eqpos == WordRef::npos ? eqpos : eqpos - 2);
 
       // long options should be longer than one character
       if (optname.size() < 2) {
-        throw AppCmdOptUnknownException(optname);
+        throw AppCmdOptUnknownException(optname.to_string());
       }
 
       // if --help is provided stop parsing
       if (::isHelpOption(optname)) {
-        _helpWanted = true;
+        state.helpWanted = true;
         break;
       }
 
       // find option with this name
-      AppCmdOptBase* option = findOpt(optname, options);
-      if (!option) {
-        throw AppCmdOptUnknownException(optname);
+      int optIndex = findOptIndex(optname);
+      if (optIndex < 0) {
+        throw AppCmdOptUnknownException(optname.to_string());
       }
+      const AppCmdOptBase* option = _allOptions[optIndex];
 
       // option argument value (only for options with arguments)
       std::string value;
       if (option->hasArgument()) {
         // take everything after the '=' or next word
-        std::string::size_type eqpos = word.find('=');
-        if (eqpos != std::string::npos) {
-          value = std::string(word, eqpos + 1);
+        if (eqpos != WordRef::npos) {
+          value.assign(word.data() + eqpos + 1, word.size() - eqpos - 1);
         } else {
-          ++_iter;
-          --_nWordsLeft;
-          value = *_iter;
+          ++state.iter;
+          if (state.iter == state.words.end()) {
+            throw AppCmdException("option requires an argument: --" + optname.to_string());
+          }
+          value.assign(state.iter->data(), state.iter->size());
         }
       }
 
       // now give it to option, this may throw
-      option->setValue(value);
+      setOptValue(state, optIndex, value, source);
 
     } else if (word.size() > 1 && word[0] == '-') {
 
       // should be short option or options
-      std::string optname(1, word[1]);
+      const WordRef optname = word.substr(1, 1);
 
       // stop on -h
       if (::isHelpOption(optname)) {
-        _helpWanted = true;
+        state.helpWanted = true;
         return;
       }
 
       // find option with this short name
-      AppCmdOptBase* option = findOpt(optname, options);
-      if (!option) {
-        throw AppCmdOptUnknownException(optname);
+      int optIndex = findOptIndex(optname);
+      if (optIndex < 0) {
+        throw AppCmdOptUnknownException(optname.to_string());
       }
+      const AppCmdOptBase* option = _allOptions[optIndex];
 
       if (option->hasArgument()) {
 
         // option expects argument, it is either the rest of this word or next word
         std::string value;
         if (word.size() == 2) {
-          ++_iter;
-          --_nWordsLeft;
-          value = *_iter;
+          ++state.iter;
+          if (state.iter == state.words.end()) {
+            throw AppCmdException("option requires an argument: -" + optname.to_string());
+          }
+          value.assign(state.iter->data(), state.iter->size());
         } else {
-          value = std::string(word, 2);
+          value.assign(word.data() + 2, word.size() - 2);
         }
         // this may throw
-        option->setValue(value);
+        setOptValue(state, optIndex, value, source);
 
       } else {
 
         // option without argument, but the word may be collection of options, like -vvqs
 
         // this may throw (but should not)
-        option->setValue("");
+        setOptValue(state, optIndex, std::string(), source);
 
         // scan remaining characters which should all be single-char options with no argument
         for (size_t i = 2; i < word.size(); ++i) {
-          std::string optname(1, word[i]);
+          const WordRef optname = word.substr(i, 1);
 
           if (::isHelpOption(optname)) {
-            _helpWanted = true;
+            state.helpWanted = true;
             return;
           }
-          AppCmdOptBase* option = findOpt(optname, options);
-          if (!option) {
-            throw AppCmdOptUnknownException(optname);
+          int optIndex = findOptIndex(optname);
+          if (optIndex < 0) {
+            throw AppCmdOptUnknownException(optname.to_string());
           }
+          const AppCmdOptBase* option = _allOptions[optIndex];
           if (option->hasArgument()) {
             // do not allow mixture
             throw AppCmdException(
-                std::string("option with argument (-") + optname
-                    + ") cannot be mixed with other options: " + word);
+                "option with argument (-" + optname.to_string()
+                    + ") cannot be mixed with other options: " + word.to_string());
           }
           // this may throw (but should not)
-          option->setValue("");
+          setOptValue(state, optIndex, std::string(), source);
         }
 
       }
@@ -463,8 +1184,7 @@ AppCmdLine::parseOptions(const OptionsList& options)
 
     }
 
-    ++_iter;
-    --_nWordsLeft;
+    ++state.iter;
 
   }
 
@@ -472,121 +1192,299 @@ AppCmdLine::parseOptions(const OptionsList& options)
 
 /// parse options file
 void
-AppCmdLine::parseOptionsFile(const OptionsList& options)
+AppCmdLine::parseOptionsFile(ParseState& state) const
 {
   if (not _optionsFile) return;
 
-  // build the list of options that were modified on the command line,
+  // remember which options were modified on the command line,
   // we do not want to change these again as command line overrides
   // options file contents.
-  std::set < std::string > changedOptions;
-  for (OptionsList::const_iterator it = options.begin(); it != options.end(); ++it) {
-    if ((*it)->valueChanged()) {
-      const std::vector<std::string>& optnames = (*it)->options();
-      changedOptions.insert(optnames.begin(), optnames.end());
+  std::vector<bool> changedOptions;
+  if (state.result) {
+    changedOptions = state.result->_optionsChanged;
+  } else {
+    changedOptions.resize(_allOptions.size());
+    for (OptionsList::size_type i = 0; i != _allOptions.size(); ++i) {
+      changedOptions[i] = _allOptions[i]->valueChanged();
     }
+    state.cmdlineOptions = changedOptions;
   }
 
-  typedef AppCmdOptList<std::string>::const_iterator OFIter;
-  for (OFIter ofiter = _optionsFile->begin(); ofiter != _optionsFile->end(); ++ofiter) {
+  // names of the options files, empty name ends the list
+  const std::vector<std::string>& allFiles = state.result ?
+      boost::any_cast<const std::vector<std::string>&>(state.result->_options[_optionsFileIndex]) :
+      _optionsFile->value();
+  const std::vector<std::string> optFiles(allFiles.begin(), std::find(allFiles.begin(), allFiles.end(), std::string()));
 
-    // find the name of the options file
-    std::string optFile = *ofiter;
-    if (optFile.empty()) {
-      // no file name given
-      return;
-    }
+  // read and split all files first, possibly in parallel
+  std::vector<OptFileData> filesData(optFiles.size());
+  readOptionsFiles(optFiles, filesData, state.batch);
 
-    // open the file
-    std::ifstream istream(optFile.c_str());
-    if (not istream) {
-      // failed to open file
-      throw AppCmdException("failed to open options file: " + optFile);
+  // included files are shared by all options files in one parse
+  state.fragments.clear();
+
+  for (size_t ifile = 0; ifile != optFiles.size(); ++ ifile) {
+
+    const std::string& optFile = optFiles[ifile];
+    AppCmdParseStats::ScopedTimer timer(state.stats ? &state.stats->file(optFile) : 0);
+    if (state.stats) state.stats->file(optFile).time += filesData[ifile].time;
+
+    // names and values are not copied
+    if (not filesData[ifile].contents) throw AppCmdException(filesData[ifile].error);
+    const AppCmdOptFile& contents = *filesData[ifile].contents;
+
+    // remember contents of the file for reloadOptionsFiles()
+    OptFileRecord* record = 0;
+    if (not state.result) {
+      state.optFiles.push_back(OptFileRecord());
+      record = &state.optFiles.back();
+      record->path = optFile;
+      record->stamp = contents.stamp();
     }
 
-    // read all the lines from the file
-    std::string line;
-    unsigned int nlines = 0;
-    while (std::getline(istream, line)) {
-      nlines++;
+    // replace include directives with the contents of included files
+    const AppCmdOptFile::Entries* entriesPtr = &contents.entries();
+    AppCmdOptFile::Entries expanded;
+    std::vector<const AppCmdOptFile*> origins;
+    if (::hasIncludes(*entriesPtr)) {
+      std::vector<std::string> stack;
+      expandOptionsFile(contents, std::string(), state.fragments, stack, expanded, record, &origins);
+      entriesPtr = &expanded;
+    }
 
-      // skip comments
-      std::string::size_type fchar = line.find_first_not_of(" \t");
-      if (fchar == std::string::npos) {
-        // empty line
-        //std::cout << "line " << nlines << ": empty\n" ;
-        continue;
-      } else if (line[fchar] == '#') {
-        // comment
-        //std::cout << "line " << nlines << ": comment\n" ;
-        continue;
-      }
+    // sources are only needed when values are stored in options
+    const AppCmdOptFile* lastOrigin = &contents;
+    unsigned lastFileIndex = record ? sourceFileIndex(state, optFile) : 0;
+
+    std::string optval;
+    const AppCmdOptFile::Entries& entries = *entriesPtr;
+    timer.setItems(entries.size());
+    const AppCmdOptFile* lastRecordOrigin = 0;
+    unsigned lastRecordIndex = 0;
+    if (record) {
+      record->entries.reserve(entries.size());
+      record->origins.reserve(entries.size());
+    }
 
-      // get option name
-      std::string::size_type optend = line.find_first_of(" \t=", fchar);
-      std::string optname(line, fchar, optend);
+    for (AppCmdOptFile::Entries::const_iterator it = entries.begin(); it != entries.end(); ++it) {
 
       // find option with this long name
-      AppCmdOptBase* option = findOpt(optname, options);
-      if (!option) {
-        throw AppCmdException("Error parsing options file: option '" + optname + "' is unknown");
+      int optIndex = findOptIndex(it->name);
+      if (optIndex < 0) {
+        throw AppCmdException("Error parsing options file: option '" + it->name.to_string() + "' is unknown");
+      }
+      const AppCmdOptFile* origin = origins.empty() ? &contents : origins[it - entries.begin()];
+      if (record) {
+        record->entries.push_back(std::make_pair(size_t(optIndex), it->value.to_string()));
+        addEntryOrigin(*record, origin, it->line, lastRecordOrigin, lastRecordIndex);
       }
 
       // if it was changed on command line do not change it again
-      if (changedOptions.find(optname) != changedOptions.end()) {
+      if (changedOptions[optIndex]) {
         continue;
       }
 
-      //std::cout << "line " << nlines << ": option '" << optname << "'\n" ;
-
-      // get option value if any
-      std::string optval;
-      if (optend != std::string::npos) {
-        std::string::size_type pos1 = line.find('=', optend);
-        //std::cout << "line " << nlines << ": pos1 = " << pos1 << "\n" ;
-        if (pos1 != std::string::npos) {
-          pos1 = line.find_first_not_of(" \t", pos1 + 1);
-          //std::cout << "line " << nlines << ": pos1 = " << pos1 << "\n" ;
-          if (pos1 != std::string::npos) {
-            std::string::size_type pos2 = line.find_last_not_of(" \t");
-            //std::cout << "line " << nlines << ": pos2 = " << pos2 << "\n" ;
-            if (pos2 != std::string::npos) {
-              optval = std::string(line, pos1, pos2 - pos1 + 1);
-            } else {
-              optval = std::string(line, pos1);
-            }
-            //std::cout << "line " << nlines << ": value '" << optval << "'\n" ;
-          }
-        }
-
+      // set the option
+      optval.assign(it->value.data(), it->value.size());
+      if (record and origin != lastOrigin) {
+        lastOrigin = origin;
+        lastFileIndex = sourceFileIndex(state, origin->path());
       }
+      setOptValue(state, optIndex, optval, ValueSource(origin, lastFileIndex, it->line));
 
-      // set the option
-      option->setValue(optval);
-      //std::cout << "line " << nlines << ": '" << optname << "' = '" << optval << "'\n" ;
+    }
+
+  }
 
+  state.fragments.clear();
+}
+
+/// read and split options files, possibly in parallel, errors are returned in data
+void
+AppCmdLine::readOptionsFiles(const std::vector<std::string>& paths, std::vector<OptFileData>& data,
+    bool serial) const
+{
+  // default is one thread per file, limited by hardware
+  const size_t maxDefaultThreads = 8;
+  size_t nThreads = _optionsFileThreads;
+  if (serial) {
+    nThreads = 1;
+  } else if (nThreads == 0) {
+    nThreads = std::min(size_t(boost::thread::hardware_concurrency()), maxDefaultThreads);
+  }
+  if (nThreads > paths.size()) nThreads = paths.size();
+
+  if (nThreads <= 1) {
+    readOptionsFilesRange(paths, data, 0, 1);
+  } else {
+    // current thread reads its share too
+    boost::thread_group threads;
+    for (size_t i = 1; i != nThreads; ++ i) {
+      threads.create_thread(boost::bind(&AppCmdLine::readOptionsFilesRange, this,
+          boost::cref(paths), boost::ref(data), i, nThreads));
+    }
+    readOptionsFilesRange(paths, data, 0, nThreads);
+    threads.join_all();
+  }
+}
+
+/// read every step-th options file starting with first one, used by readOptionsFiles()
+void
+AppCmdLine::readOptionsFilesRange(const std::vector<std::string>& paths, std::vector<OptFileData>& data,
+    size_t first, size_t step) const
+{
+  for (size_t i = first; i < paths.size(); i += step) {
+    const double start = AppCmdParseStats::now();
+    try {
+      data[i].contents.reset(new AppCmdOptFile(paths[i], _optionsFileCache));
+    } catch (const std::exception& exc) {
+      data[i].error = exc.what();
+    }
+    data[i].time = AppCmdParseStats::now() - start;
+  }
+}
+
+/// read options file and find options for all its lines, throws on unknown options
+void
+AppCmdLine::readOptionsFile(const std::string& path, OptFileRecord& record) const
+{
+  const AppCmdOptFile contents(path, _optionsFileCache);
+
+  record.path = path;
+  record.stamp = contents.stamp();
+  record.includes.clear();
+  record.entries.clear();
+  record.originFiles.clear();
+  record.origins.clear();
+
+  const AppCmdOptFile::Entries* entriesPtr = &contents.entries();
+  AppCmdOptFile::Entries expanded;
+  std::vector<const AppCmdOptFile*> origins;
+  FragmentCache fragments;
+  if (::hasIncludes(*entriesPtr)) {
+    std::vector<std::string> stack;
+    expandOptionsFile(contents, std::string(), fragments, stack, expanded, &record, &origins);
+    entriesPtr = &expanded;
+  }
+
+  const AppCmdOptFile::Entries& entries = *entriesPtr;
+  record.entries.reserve(entries.size());
+  record.origins.reserve(entries.size());
+  const AppCmdOptFile* lastOrigin = 0;
+  unsigned lastIndex = 0;
+  for (AppCmdOptFile::Entries::const_iterator it = entries.begin(); it != entries.end(); ++it) {
+    int optIndex = findOptIndex(it->name);
+    if (optIndex < 0) {
+      throw AppCmdException("Error parsing options file: option '" + it->name.to_string() + "' is unknown");
+    }
+    record.entries.push_back(std::make_pair(size_t(optIndex), it->value.to_string()));
+    const AppCmdOptFile* origin = origins.empty() ? &contents : origins[it - entries.begin()];
+    addEntryOrigin(record, origin, it->line, lastOrigin, lastIndex);
+  }
+}
+
+/// append entries of the options file to the list replacing include directives
+void
+AppCmdLine::expandOptionsFile(const AppCmdOptFile& file, const std::string& key, FragmentCache& fragments,
+    std::vector<std::string>& stack, AppCmdOptFile::Entries& entries, OptFileRecord* record,
+    std::vector<const AppCmdOptFile*>* origins) const
+{
+  // canonical path of the top-level file is only needed if it includes something
+  stack.push_back(key);
+
+  const AppCmdOptFile::Entries& fileEntries = file.entries();
+  for (AppCmdOptFile::Entries::const_iterator it = fileEntries.begin(); it != fileEntries.end(); ++it) {
+
+    if (it->name != AppCmdOptFile::includeDirective) {
+      entries.push_back(*it);
+      if (origins) origins->push_back(&file);
+      continue;
+    }
+
+    const std::string where = "Error parsing options file " + file.path() + ", line "
+        + boost::lexical_cast<std::string>(it->line) + ": ";
+    if (it->value.empty()) {
+      throw AppCmdException(where + "file name is missing in include directive");
     }
 
-    // check the status of the file, must be at EOF
-    if (not istream.eof()) {
-      throw AppCmdException(
-          "failure when reading options file, at or around line " + boost::lexical_cast < std::string > (nlines));
+    // relative paths are relative to the directory of the including file
+    fs::path incPath(it->value.to_string());
+    if (incPath.is_relative()) incPath = fs::path(file.path()).parent_path() / incPath;
+    const std::string incKey = ::canonicalPath(incPath.string());
+    if (incKey.empty()) {
+      throw AppCmdException(where + "failed to open included file " + incPath.string());
     }
 
+    if (stack.back().empty()) stack.back() = ::canonicalPath(file.path());
+    if (std::find(stack.begin(), stack.end(), incKey) != stack.end()) {
+      throw AppCmdException(where + "recursive include of " + incPath.string());
+    }
+
+    // each included file is read only once
+    boost::shared_ptr<const AppCmdOptFile>& fragment = fragments[incKey];
+    if (not fragment) fragment.reset(new AppCmdOptFile(incPath.string(), _optionsFileCache));
+    if (record) record->includes.push_back(std::make_pair(incKey, fragment->stamp()));
+
+    expandOptionsFile(*fragment, incKey, fragments, stack, entries, record, origins);
+  }
+
+  stack.pop_back();
+}
+
+/// returns true if any of the files in the record changed since they were read
+bool
+AppCmdLine::optionsFileChanged(const OptFileRecord& record)
+{
+  AppCmdOptFile::Stamp stamp;
+  if (not AppCmdOptFile::stamp(record.path, stamp) or stamp != record.stamp) return true;
+  for (size_t i = 0; i != record.includes.size(); ++ i) {
+    if (not AppCmdOptFile::stamp(record.includes[i].first, stamp) or stamp != record.includes[i].second) return true;
   }
+  return false;
+}
+
+/// add entry origin to the record, lastOrigin and lastIndex remember the last origin file
+void
+AppCmdLine::addEntryOrigin(OptFileRecord& record, const AppCmdOptFile* origin, unsigned line,
+    const AppCmdOptFile*& lastOrigin, unsigned& lastIndex)
+{
+  if (origin != lastOrigin) {
+    lastOrigin = origin;
+    std::vector<std::string>::const_iterator it =
+        std::find(record.originFiles.begin(), record.originFiles.end(), origin->path());
+    lastIndex = it - record.originFiles.begin();
+    if (it == record.originFiles.end()) record.originFiles.push_back(origin->path());
+  }
+  record.origins.push_back(std::make_pair(lastIndex, line));
 }
 
 /// parse arguments
 void
-AppCmdLine::parseArgs()
+AppCmdLine::parseArgs(ParseState& state) const
+{
+  // argument classes need strings, make them only for remaining words
+  state.args.clear();
+  for (WordList::const_iterator wit = state.iter; wit != state.words.end(); ++ wit) {
+    state.args.push_back(wit->to_string());
+    if (state.stats) state.stats->addString(wit->size());
+  }
+
+  assignArgs(state);
+}
+
+/// give words in state.args to positional arguments
+void
+AppCmdLine::assignArgs(ParseState& state) const
 {
+  StringList::const_iterator iter = state.args.begin();
+  int nWordsLeft = state.args.size();
   int nPosLeft = _positionals.size();
   for (PositionalsList::const_iterator it = _positionals.begin(); it != _positionals.end(); ++it) {
 
     // number of positional args left after the current one
     --nPosLeft;
 
-    if (_iter == _argv.end()) {
+    if (iter == state.args.end()) {
       // no data left
       bool ok = !(*it)->isRequired();
       if (!ok) {
@@ -599,40 +1497,172 @@ AppCmdLine::parseArgs()
     size_t nWordsToGive = 1;
     if ((*it)->maxWords() > 1) {
       // but can get more
-      if (_nWordsLeft <= nPosLeft) {
+      if (nWordsLeft <= nPosLeft) {
         // too few words left
         throw AppCmdArgListTooShort();
       }
-      nWordsToGive = _nWordsLeft - nPosLeft;
+      nWordsToGive = nWordsLeft - nPosLeft;
     }
 
-    StringList::const_iterator w_end = _iter;
+    StringList::const_iterator w_end = iter;
     std::advance(w_end, nWordsToGive);
     // this can throw
-    int consumed = (*it)->setValue(_iter, w_end);
-    std::advance(_iter, consumed);
-    _nWordsLeft -= consumed;
+    int consumed;
+    if (state.result) {
+      consumed = (*it)->updateValue(iter, w_end, state.result->_args[it - _positionals.begin()]);
+    } else {
+      consumed = (*it)->setValue(iter, w_end);
+    }
+    std::advance(iter, consumed);
+    nWordsLeft -= consumed;
 
   }
 
-  if (_iter != _argv.end()) {
+  if (iter != state.args.end()) {
     // not whole line is consumed
     throw AppCmdArgListTooLong();
   }
 
 }
 
-/// find option with the long name
-AppCmdOptBase*
-AppCmdLine::findOpt(const std::string& opt, const OptionsList& options) const
+/// position of the file in state.sourceFiles, file is added if it is not there
+unsigned
+AppCmdLine::sourceFileIndex(ParseState& state, const std::string& path)
 {
-  for (OptionsList::const_iterator it = options.begin(); it != options.end(); ++it) {
-    const std::vector<std::string>& optnames = (*it)->options();
-    if (std::find(optnames.begin(), optnames.end(), opt) != optnames.end()) {
-      return *it;
+  std::vector<std::string>::const_iterator it = std::find(state.sourceFiles.begin(), state.sourceFiles.end(), path);
+  if (it != state.sourceFiles.end()) return it - state.sourceFiles.begin();
+  state.sourceFiles.push_back(path);
+  return state.sourceFiles.size() - 1;
+}
+
+/// give value to an option, it is stored in option itself or in the value store
+void
+AppCmdLine::setOptValue(ParseState& state, size_t optIndex, const std::string& value,
+    const ValueSource& source) const
+{
+  if (state.recordValues) {
+    state.values.push_back(ValueRecord());
+    ValueRecord& record = state.values.back();
+    record.optIndex = optIndex;
+    record.value = value;
+    if (source.file) {
+      record.source = "file:" + source.file->path() + ":" + boost::lexical_cast<std::string>(source.line);
+    } else {
+      record.source = "cmdline:" + boost::lexical_cast<std::string>(source.word);
     }
   }
-  return 0;
+
+  AppCmdParseStats::ScopedTimer timer(state.stats ? &state.optStats[optIndex] : 0, value.size());
+  if (state.stats and not value.empty()) state.stats->addString(value.size());
+  if (AppCmdParseResult* result = state.result) {
+    _allOptions[optIndex]->updateValue(value, result->_options[optIndex]);
+    result->_optionsChanged[optIndex] = true;
+  } else {
+    _allOptions[optIndex]->setValue(value);
+
+    SourceEntry& entry = state.sources[optIndex];
+    entry.source = source.file ? Provenance::OptionsFile : Provenance::CommandLine;
+    entry.word = source.word;
+    entry.fileIndex = source.fileIndex;
+    entry.line = source.line;
+    ++ entry.count;
+  }
+}
+
+/// parse every step-th command line starting with first one
+void
+AppCmdLine::parseBatchRange(const std::vector<StringList>& cmdlines, BatchResults& results,
+    size_t first, size_t step) const
+{
+  ParseState state;
+  AppCmdParseResult result;
+  state.result = &result;
+  // batch already runs in many threads, options files are read sequentially
+  state.batch = true;
+
+  for (size_t i = first; i < cmdlines.size(); i += step) {
+
+    const StringList& words = cmdlines[i];
+    clearWords(state);
+    for (StringList::const_iterator it = words.begin(); it != words.end(); ++ it) {
+      appendWord(state, *it);
+    }
+
+    BatchResult& result = results[i];
+    try {
+      doParse(state);
+      result.ok = true;
+      result.helpWanted = state.helpWanted;
+    } catch (const std::exception& exc) {
+      result.error = exc.what();
+    }
+  }
+}
+
+/// build full list of options from all groups
+void
+AppCmdLine::allOptions(OptionsList& options) const
+{
+  options = this->options();
+  for (GroupsList::const_iterator git = _groups.begin(); git != _groups.end(); ++ git) {
+    const OptionsList& groupOptions = (*git)->options();
+    options.insert(options.end(), groupOptions.begin(), groupOptions.end());
+  }
+}
+
+/// build option name index, throws on duplicate names
+void
+AppCmdLine::buildIndex(const OptionsList& options)
+{
+  _optIndex.clear();
+  for (OptionsList::size_type i = 0; i != options.size(); ++i) {
+    const std::vector<std::string>& optnames = options[i]->options();
+    for (std::vector<std::string>::const_iterator it = optnames.begin(); it != optnames.end(); ++it) {
+      if (not _optIndex.insert(OptionsIndex::value_type(*it, i)).second) {
+        throw AppCmdOptDefinedException(*it);
+      }
+    }
+  }
+}
+
+/// find option with the given name, returns its position or -1
+int
+AppCmdLine::findOptIndex(WordRef opt) const
+{
+  OptionsIndex::const_iterator it = _optIndex.find(opt, OptNameHash(), OptNameEqual());
+  if (it == _optIndex.end()) return -1;
+  return it->second;
+}
+
+/// find position of the option in the parser, uses name index, so it is
+/// only valid after buildSchema()
+int
+AppCmdLine::findOptIndex(const AppCmdOptBase* opt) const
+{
+  const std::vector<std::string>& optnames = opt->options();
+  if (optnames.empty()) return -1;
+  OptionsIndex::const_iterator it = _optIndex.find(optnames.front());
+  // other option with the same name may be known to the parser
+  if (it == _optIndex.end() or _allOptions[it->second] != opt) return -1;
+  return it->second;
+}
+
+/// find position of the positional argument in the parser
+int
+AppCmdLine::findArgIndex(const AppCmdArgBase* arg) const
+{
+  PositionalsList::const_iterator it = std::find(_positionals.begin(), _positionals.end(), arg);
+  if (it == _positionals.end()) return -1;
+  return it - _positionals.begin();
+}
+
+/// find option with the given name
+AppCmdOptBase*
+AppCmdLine::findOpt(WordRef opt) const
+{
+  int idx = findOptIndex(opt);
+  if (idx < 0) return 0;
+  return _allOptions[idx];
 }
 
 void
@@ -95,4 +95,26 @@ AppCmdOptBase::AppCmdOptBase(const std::string& optNames,
   }
 }
 
+// Reset value stored outside of option to option's default value.
+void
+AppCmdOptBase::resetValue(boost::any& value) const
+{
+  throw AppCmdException("option does not support external value storage: " + (_options.empty() ? _name : _options.back()));
+}
+
+// Update value stored outside of option with option's argument.
+void
+AppCmdOptBase::updateValue(const std::string& str, boost::any& value) const
+{
+  throw AppCmdException("option does not support external value storage: " + (_options.empty() ? _name : _options.back()));
+}
+
+/**
+ *  Convert option argument if its conversion was deferred.
+ */
+void
+AppCmdOptBase::validate() const
+{
+}
+
 } // namespace AppUtils
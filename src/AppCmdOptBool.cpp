@@ -113,4 +113,22 @@ AppCmdOptBool::reset()
   _changed = false ;
 }
 
+/**
+ *  Reset value stored outside of option to option's default value.
+ */
+void
+AppCmdOptBool::resetValue ( boost::any& value ) const
+{
+  value = _defValue ;
+}
+
+/**
+ *  Update value stored outside of option.
+ */
+void
+AppCmdOptBool::updateValue ( const std::string& str, boost::any& value ) const
+{
+  value = value_type(! _defValue) ;
+}
+
 } // namespace AppUtils
@@ -0,0 +1,408 @@
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Class AppCmdOptFile...
+//
+// Author List:
+//      Andy Salnikov
+//
+//------------------------------------------------------------------------
+
+//-----------------------
+// This Class's Header --
+//-----------------------
+#include "AppUtils/AppCmdOptFile.h"
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include <stdio.h>
+#include <cstring>
+#include <limits>
+#include <stdint.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <boost/filesystem.hpp>
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+#include "AppUtils/AppCmdExceptions.h"
+
+//-----------------------------------------------------------------------
+// Local Macros, Typedefs, Structures, Unions and Forward Declarations --
+//-----------------------------------------------------------------------
+
+namespace {
+
+typedef boost::string_ref WordRef;
+
+// Layout of the cache file: header, absolute path of the options file
+// (padded to multiple of 4 bytes), table of entries, and a blob with all
+// names and values. Offsets in the entries are relative to the blob start.
+// Native byte order is used, cache is not meant to be portable. Last
+// character of magic is the format version, version 2 splits include
+// directives without '='.
+const char cacheMagic[8] = { 'A', 'p', 'p', 'O', 'p', 't', 'C', '2' };
+
+struct CacheHeader {
+  char magic[8];
+  uint64_t srcSize;       // size of the options file
+  int64_t srcMtime;       // modification time of the options file
+  int64_t srcMtimeNsec;
+  uint64_t srcHash;       // hash of the options file contents
+  uint32_t pathLen;       // length of the options file path
+  uint32_t nEntries;      // number of entries
+  uint64_t blobSize;      // size of the names/values blob
+};
+
+struct CacheEntry {
+  uint32_t line;
+  uint32_t nameOff;
+  uint32_t nameLen;
+  uint32_t valueOff;
+  uint32_t valueLen;
+};
+
+// FNV-1a hash, used for the contents of files and for cache file names
+uint64_t
+fnvHash(const char* data, size_t size)
+{
+  uint64_t hash = 14695981039346656037ULL;
+  for (const char* const end = data + size; data != end; ++ data) {
+    hash ^= uint64_t(static_cast<unsigned char>(*data));
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+// size of header plus path, rounded up to multiple of 4
+size_t
+cacheEntriesOffset(size_t pathLen)
+{
+  return (sizeof(CacheHeader) + pathLen + 3) / 4 * 4;
+}
+
+}
+
+//		----------------------------------------
+// 		-- Public Function Member Definitions --
+//		----------------------------------------
+
+namespace AppUtils {
+
+// Contents of the file. Regular files are memory-mapped, for other kinds
+// of files (pipes, devices) which cannot be mapped the contents is read
+// into memory.
+class AppCmdOptFile::Data {
+public:
+
+  Data() : m_map(0), m_size(0), m_buf() {}
+
+  ~Data() {
+    if (m_map) ::munmap(m_map, m_size);
+  }
+
+  // read the file and fill its status, returns false if file cannot be read
+  bool load(const std::string& path, struct stat& st)
+  {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    if (::fstat(fd, &st) != 0) {
+      ::close(fd);
+      return false;
+    }
+
+    if (S_ISREG(st.st_mode) and st.st_size > 0) {
+      void* map = ::mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (map != MAP_FAILED) {
+        m_map = map;
+        m_size = st.st_size;
+        ::madvise(m_map, m_size, MADV_SEQUENTIAL);
+      }
+    }
+
+    bool ok = true;
+    if (not m_map) {
+      // cannot map, read it in
+      char buf[64*1024];
+      ssize_t n;
+      while ((n = ::read(fd, buf, sizeof buf)) > 0) {
+        m_buf.append(buf, n);
+      }
+      ok = n == 0;
+    }
+
+    ::close(fd);
+    return ok;
+  }
+
+  const char* data() const { return m_map ? static_cast<const char*>(m_map) : m_buf.data(); }
+  size_t size() const { return m_map ? m_size : m_buf.size(); }
+
+private:
+
+  void* m_map;
+  size_t m_size;
+  std::string m_buf;
+
+  // This class is non-copyable
+  Data(const Data&);
+  Data& operator=(const Data&);
+};
+
+//----------------
+// Constructors --
+//----------------
+AppCmdOptFile::AppCmdOptFile(const std::string& path, const std::string& cacheDir)
+  : m_path(path)
+  , m_data(new Data)
+  , m_entries()
+  , m_fromCache(false)
+  , m_stamp()
+{
+  // cache file name is made from the hash of absolute path
+  std::string absPath;
+  std::string cachePath;
+  if (not cacheDir.empty()) {
+    try {
+      absPath = boost::filesystem::absolute(path).string();
+      char hexHash[32];
+      snprintf(hexHash, sizeof hexHash, "%016llx", (unsigned long long)::fnvHash(absPath.data(), absPath.size()));
+      cachePath = cacheDir + "/" + hexHash + ".optcache";
+    } catch (const boost::filesystem::filesystem_error&) {
+      // no cache then
+    }
+  }
+
+  if (not cachePath.empty()) {
+    struct stat st;
+    if (::stat(path.c_str(), &st) == 0 and S_ISREG(st.st_mode)) {
+      if (loadCache(cachePath, absPath, st)) {
+        m_fromCache = true;
+        m_stamp = Stamp(st);
+        return;
+      }
+      m_entries.clear();
+      m_data.reset(new Data);
+    }
+  }
+
+  struct stat st;
+  if (not m_data->load(path, st)) {
+    throw AppCmdException("failed to open options file: " + path);
+  }
+  m_stamp = Stamp(st);
+
+  split();
+
+  if (not cachePath.empty() and S_ISREG(st.st_mode)) {
+    saveCache(cachePath, absPath, st, ::fnvHash(m_data->data(), m_data->size()));
+  }
+}
+
+//--------------
+// Destructor --
+//--------------
+AppCmdOptFile::~AppCmdOptFile()
+{
+}
+
+// Name of the include directive
+const char* const AppCmdOptFile::includeDirective = "@include";
+
+// Get modification time and size of a file without reading it.
+bool
+AppCmdOptFile::stamp(const std::string& path, Stamp& stamp)
+{
+  return AppFileStamp::get(path, stamp);
+}
+
+// split text data into entries
+void
+AppCmdOptFile::split()
+{
+  const char* p = m_data->data();
+  const char* const end = p + m_data->size();
+
+  unsigned nlines = 0;
+  while (p != end) {
+
+    // get next line
+    const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    if (not eol) eol = end;
+    const WordRef line(p, eol - p);
+    p = eol == end ? end : eol + 1;
+    ++ nlines;
+
+    // skip comments
+    WordRef::size_type fchar = line.find_first_not_of(" \t");
+    if (fchar == WordRef::npos) {
+      // empty line
+      continue;
+    } else if (line[fchar] == '#') {
+      // comment
+      continue;
+    }
+
+    // get option name
+    const WordRef rest = line.substr(fchar);
+    const WordRef::size_type optend = rest.find_first_of(" \t=");
+
+    Entry entry;
+    entry.name = rest.substr(0, optend);
+    entry.line = nlines;
+
+    // get option value if any, everything after '=' without leading and trailing blanks
+    if (optend != WordRef::npos) {
+      WordRef value = rest.substr(optend);
+      const WordRef::size_type eqpos = value.find('=');
+      if (eqpos != WordRef::npos) {
+        value = value.substr(eqpos + 1);
+        const WordRef::size_type pos1 = value.find_first_not_of(" \t");
+        if (pos1 != WordRef::npos) {
+          const WordRef::size_type pos2 = value.find_last_not_of(" \t");
+          entry.value = value.substr(pos1, pos2 - pos1 + 1);
+        }
+      } else if (entry.name == includeDirective) {
+        // "@include path" is the same as "@include = path"
+        const WordRef::size_type pos1 = value.find_first_not_of(" \t");
+        if (pos1 != WordRef::npos) {
+          const WordRef::size_type pos2 = value.find_last_not_of(" \t");
+          entry.value = value.substr(pos1, pos2 - pos1 + 1);
+        }
+      }
+    }
+
+    m_entries.push_back(entry);
+  }
+}
+
+// try to load entries from cache file, returns false if cache is not valid
+bool
+AppCmdOptFile::loadCache(const std::string& cachePath, const std::string& absPath, const struct stat& st)
+{
+  struct stat cst;
+  if (not m_data->load(cachePath, cst)) return false;
+
+  const char* const data = m_data->data();
+  const size_t size = m_data->size();
+
+  // check that header and path are consistent with the file
+  CacheHeader hdr;
+  if (size < sizeof hdr) return false;
+  std::memcpy(&hdr, data, sizeof hdr);
+  if (std::memcmp(hdr.magic, ::cacheMagic, sizeof hdr.magic) != 0) return false;
+  if (hdr.srcSize != uint64_t(st.st_size)) return false;
+  if (hdr.pathLen != absPath.size() or size < sizeof hdr + hdr.pathLen) return false;
+  if (absPath.compare(0, std::string::npos, data + sizeof hdr, hdr.pathLen) != 0) return false;
+
+  // check sizes of entries table and blob
+  const size_t entOffset = ::cacheEntriesOffset(hdr.pathLen);
+  if (size < entOffset or hdr.nEntries > (size - entOffset) / sizeof(CacheEntry)) return false;
+  const size_t blobOffset = entOffset + hdr.nEntries * sizeof(CacheEntry);
+  if (hdr.blobSize != size - blobOffset) return false;
+
+  // if modification time changed check that contents is the same
+  bool refresh = false;
+  if (hdr.srcMtime != int64_t(st.st_mtim.tv_sec) or hdr.srcMtimeNsec != int64_t(st.st_mtim.tv_nsec)) {
+    Data src;
+    struct stat sst;
+    if (not src.load(m_path, sst)) return false;
+    if (::fnvHash(src.data(), src.size()) != hdr.srcHash) return false;
+    refresh = true;
+  }
+
+  const char* blob = data + blobOffset;
+  m_entries.reserve(hdr.nEntries);
+  for (uint32_t i = 0; i != hdr.nEntries; ++ i) {
+    CacheEntry centry;
+    std::memcpy(&centry, data + entOffset + i * sizeof centry, sizeof centry);
+    if (uint64_t(centry.nameOff) + centry.nameLen > hdr.blobSize or
+        uint64_t(centry.valueOff) + centry.valueLen > hdr.blobSize) {
+      return false;
+    }
+    Entry entry;
+    entry.name = WordRef(blob + centry.nameOff, centry.nameLen);
+    entry.value = WordRef(blob + centry.valueOff, centry.valueLen);
+    entry.line = centry.line;
+    m_entries.push_back(entry);
+  }
+
+  // update modification time in cache so that next time hash is not needed
+  if (refresh) saveCache(cachePath, absPath, st, hdr.srcHash);
+
+  return true;
+}
+
+// save entries to cache file, errors are ignored
+void
+AppCmdOptFile::saveCache(const std::string& cachePath, const std::string& absPath, const struct stat& st,
+    unsigned long long hash) const
+{
+  // build the table and the blob
+  std::vector<CacheEntry> centries;
+  centries.reserve(m_entries.size());
+  std::string blob;
+  for (Entries::const_iterator it = m_entries.begin(); it != m_entries.end(); ++ it) {
+    CacheEntry centry;
+    centry.line = it->line;
+    centry.nameOff = blob.size();
+    centry.nameLen = it->name.size();
+    blob.append(it->name.data(), it->name.size());
+    centry.valueOff = blob.size();
+    centry.valueLen = it->value.size();
+    blob.append(it->value.data(), it->value.size());
+    centries.push_back(centry);
+  }
+  // offsets are 32-bit, do not cache huge files
+  if (blob.size() > std::numeric_limits<uint32_t>::max()) return;
+
+  CacheHeader hdr;
+  std::memcpy(hdr.magic, ::cacheMagic, sizeof hdr.magic);
+  hdr.srcSize = st.st_size;
+  hdr.srcMtime = st.st_mtim.tv_sec;
+  hdr.srcMtimeNsec = st.st_mtim.tv_nsec;
+  hdr.srcHash = hash;
+  hdr.pathLen = absPath.size();
+  hdr.nEntries = centries.size();
+  hdr.blobSize = blob.size();
+
+  std::string buf(reinterpret_cast<const char*>(&hdr), sizeof hdr);
+  buf += absPath;
+  buf.resize(::cacheEntriesOffset(absPath.size()), '\0');
+  if (not centries.empty()) {
+    buf.append(reinterpret_cast<const char*>(&centries[0]), centries.size() * sizeof(CacheEntry));
+  }
+  buf += blob;
+
+  // write to a temporary file and rename it, other processes may read the same cache
+  std::vector<char> tmpPath(cachePath.begin(), cachePath.end());
+  const char suffix[] = ".XXXXXX";
+  tmpPath.insert(tmpPath.end(), suffix, suffix + sizeof suffix);
+  int fd = ::mkstemp(&tmpPath[0]);
+  if (fd < 0) return;
+  ::fchmod(fd, 0644);
+
+  bool ok = true;
+  for (size_t pos = 0; pos < buf.size(); ) {
+    ssize_t n = ::write(fd, buf.data() + pos, buf.size() - pos);
+    if (n <= 0) {
+      ok = false;
+      break;
+    }
+    pos += n;
+  }
+  if (::close(fd) != 0) ok = false;
+
+  if (not ok or ::rename(&tmpPath[0], cachePath.c_str()) != 0) {
+    ::unlink(&tmpPath[0]);
+  }
+}
+
+} // namespace AppUtils
@@ -111,6 +111,24 @@ AppCmdOptIncr::reset()
   _changed = false ;
 }
 
+/**
+ *  Reset value stored outside of option to option's default value.
+ */
+void
+AppCmdOptIncr::resetValue ( boost::any& value ) const
+{
+  value = _defValue ;
+}
+
+/**
+ *  Update value stored outside of option.
+ */
+void
+AppCmdOptIncr::updateValue ( const std::string& str, boost::any& value ) const
+{
+  ++ boost::any_cast<value_type&>(value) ;
+}
+
 std::string
 AppCmdOptIncr::description() const
 {
@@ -31,6 +31,34 @@
 // Local Macros, Typedefs, Structures, Unions and Forward Declarations --
 //-----------------------------------------------------------------------
 
+namespace {
+
+// convert string with optional k/M/G suffix to a number
+AppUtils::AppCmdOptSize::value_type
+strToSize ( const std::string& value )
+{
+  char* eptr ;
+  AppUtils::AppCmdOptSize::value_type tmp = std::strtoull ( value.c_str(), &eptr, 0 ) ;
+  switch ( *eptr ) {
+  case 'G' :
+    tmp *= 1024 ;
+  case 'M' :
+    tmp *= 1024 ;
+  case 'k' :
+  case 'K' :
+    tmp *= 1024 ;
+    ++ eptr ;
+  case '\0' :
+    break ;
+  }
+
+  if ( *eptr != '\0' ) throw AppUtils::AppCmdTypeCvtException ( value, "size" ) ;
+
+  return tmp ;
+}
+
+}
+
 //		----------------------------------------
 // 		-- Public Function Member Definitions --
 //		----------------------------------------
@@ -80,24 +108,7 @@ AppCmdOptSize::hasArgument() const
 void
 AppCmdOptSize::setValue ( const std::string& value )
 {
-  char* eptr ;
-  value_type tmp = std::strtoull ( value.c_str(), &eptr, 0 ) ;
-  switch ( *eptr ) {
-  case 'G' :
-    tmp *= 1024 ;
-  case 'M' :
-    tmp *= 1024 ;
-  case 'k' :
-  case 'K' :
-    tmp *= 1024 ;
-    ++ eptr ;
-  case '\0' :
-    break ;
-  }
-
-  if ( *eptr != '\0' ) throw AppCmdTypeCvtException ( value, "size" ) ;
-
-  _value = tmp ;
+  _value = ::strToSize ( value ) ;
   _changed = true ;
 }
 
@@ -149,4 +160,22 @@ AppCmdOptSize::reset()
   _changed = false ;
 }
 
+/**
+ *  Reset value stored outside of option to option's default value.
+ */
+void
+AppCmdOptSize::resetValue ( boost::any& value ) const
+{
+  value = _defValue ;
+}
+
+/**
+ *  Update value stored outside of option.
+ */
+void
+AppCmdOptSize::updateValue ( const std::string& str, boost::any& value ) const
+{
+  value = ::strToSize ( str ) ;
+}
+
 } // namespace AppUtils
@@ -114,4 +114,23 @@ AppCmdOptToggle::reset()
   _changed = false ;
 }
 
+/**
+ *  Reset value stored outside of option to option's default value.
+ */
+void
+AppCmdOptToggle::resetValue ( boost::any& value ) const
+{
+  value = _defValue ;
+}
+
+/**
+ *  Update value stored outside of option.
+ */
+void
+AppCmdOptToggle::updateValue ( const std::string& str, boost::any& value ) const
+{
+  value_type& val = boost::any_cast<value_type&>(value) ;
+  val = ! val ;
+}
+
 } // namespace AppUtils
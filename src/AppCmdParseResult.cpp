@@ -0,0 +1,126 @@
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Class AppCmdParseResult...
+//
+// Author List:
+//      Andy Salnikov
+//
+//------------------------------------------------------------------------
+
+//-----------------------
+// This Class's Header --
+//-----------------------
+#include "AppUtils/AppCmdParseResult.h"
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+#include "AppUtils/AppCmdExceptions.h"
+#include "AppUtils/AppCmdLine.h"
+#include "AppUtils/AppCmdOptBool.h"
+#include "AppUtils/AppCmdOptIncr.h"
+#include "AppUtils/AppCmdOptSize.h"
+#include "AppUtils/AppCmdOptToggle.h"
+
+//-----------------------------------------------------------------------
+// Local Macros, Typedefs, Structures, Unions and Forward Declarations --
+//-----------------------------------------------------------------------
+
+//		----------------------------------------
+// 		-- Public Function Member Definitions --
+//		----------------------------------------
+
+namespace AppUtils {
+
+//----------------
+// Constructors --
+//----------------
+AppCmdParseResult::AppCmdParseResult()
+  : _parser(0)
+  , _options()
+  , _optionsChanged()
+  , _args()
+  , _helpWanted(false)
+{
+}
+
+//--------------
+// Destructor --
+//--------------
+AppCmdParseResult::~AppCmdParseResult()
+{
+}
+
+bool
+AppCmdParseResult::valueChanged(const AppCmdOptBase& opt) const
+{
+  return _optionsChanged[optIndex(opt)];
+}
+
+int
+AppCmdParseResult::value(const AppCmdOptIncr& opt) const
+{
+  return boost::any_cast<AppCmdOptIncr::value_type>(optValue(opt));
+}
+
+bool
+AppCmdParseResult::value(const AppCmdOptToggle& opt) const
+{
+  return boost::any_cast<AppCmdOptToggle::value_type>(optValue(opt));
+}
+
+bool
+AppCmdParseResult::value(const AppCmdOptBool& opt) const
+{
+  return boost::any_cast<AppCmdOptBool::value_type>(optValue(opt));
+}
+
+unsigned long long
+AppCmdParseResult::value(const AppCmdOptSize& opt) const
+{
+  return boost::any_cast<AppCmdOptSize::value_type>(optValue(opt));
+}
+
+// get stored option value, throws if option is not known
+const boost::any&
+AppCmdParseResult::optValue(const AppCmdOptBase& opt) const
+{
+  return _options[optIndex(opt)];
+}
+
+// get stored argument value, throws if argument is not known
+const boost::any&
+AppCmdParseResult::argValue(const AppCmdArgBase& arg) const
+{
+  if (not _parser) {
+    throw AppCmdException("parse result is empty, parse() has not been called");
+  }
+  int idx = _parser->findArgIndex(&arg);
+  if (idx < 0) {
+    throw AppCmdException("argument is not known to the parser");
+  }
+  return _args[idx];
+}
+
+// get position of the option in the parser, throws if option is not known
+size_t
+AppCmdParseResult::optIndex(const AppCmdOptBase& opt) const
+{
+  if (not _parser) {
+    throw AppCmdException("parse result is empty, parse() has not been called");
+  }
+  int idx = _parser->findOptIndex(&opt);
+  if (idx < 0) {
+    throw AppCmdException("option is not known to the parser");
+  }
+  return idx;
+}
+
+} // namespace AppUtils
@@ -0,0 +1,175 @@
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Class AppCmdParseStats...
+//
+// Author List:
+//      Andy Salnikov
+//
+//------------------------------------------------------------------------
+
+//-----------------------
+// This Class's Header --
+//-----------------------
+#include "AppUtils/AppCmdParseStats.h"
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include <cstdio>
+#include <ostream>
+#include <time.h>
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+
+//-----------------------------------------------------------------------
+// Local Macros, Typedefs, Structures, Unions and Forward Declarations --
+//-----------------------------------------------------------------------
+
+namespace {
+
+const char* phaseNames[] = { "split", "reset", "options", "optionsFile", "args" };
+
+// print string as JSON string literal
+void
+printJsonString(std::ostream& out, const std::string& str)
+{
+  out << '"';
+  for (std::string::const_iterator it = str.begin(); it != str.end(); ++ it) {
+    const unsigned char c = *it;
+    if (c == '"' or c == '\\') {
+      out << '\\' << char(c);
+    } else if (c < 0x20) {
+      char buf[8];
+      std::snprintf(buf, sizeof buf, "\\u%04x", unsigned(c));
+      out << buf;
+    } else {
+      out << char(c);
+    }
+  }
+  out << '"';
+}
+
+// print one counter as JSON object
+void
+printCounter(std::ostream& out, const AppUtils::AppCmdParseStats::Counter& counter)
+{
+  out << "{\"count\": " << counter.count << ", \"items\": " << counter.items
+      << ", \"time\": " << counter.time << "}";
+}
+
+// print map of counters as JSON object
+void
+printCounters(std::ostream& out, const AppUtils::AppCmdParseStats::CounterMap& counters)
+{
+  out << "{";
+  typedef AppUtils::AppCmdParseStats::CounterMap::const_iterator Iter;
+  for (Iter it = counters.begin(); it != counters.end(); ++ it) {
+    if (it != counters.begin()) out << ",";
+    out << "\n    ";
+    printJsonString(out, it->first);
+    out << ": ";
+    printCounter(out, it->second);
+  }
+  if (not counters.empty()) out << "\n  ";
+  out << "}";
+}
+
+}
+
+//		----------------------------------------
+// 		-- Public Function Member Definitions --
+//		----------------------------------------
+
+namespace AppUtils {
+
+//----------------
+// Constructors --
+//----------------
+AppCmdParseStats::AppCmdParseStats()
+  : _total()
+  , _failures(0)
+  , _files()
+  , _options()
+  , _strings(0)
+  , _stringBytes(0)
+{
+}
+
+//--------------
+// Destructor --
+//--------------
+AppCmdParseStats::~AppCmdParseStats()
+{
+}
+
+/// Reset all counters
+void
+AppCmdParseStats::clear()
+{
+  *this = AppCmdParseStats();
+}
+
+/// Add counters from other instance
+void
+AppCmdParseStats::merge(const AppCmdParseStats& other)
+{
+  _total.merge(other._total);
+  _failures += other._failures;
+  for (int i = 0; i != NPhases; ++ i) {
+    _phases[i].merge(other._phases[i]);
+  }
+  for (CounterMap::const_iterator it = other._files.begin(); it != other._files.end(); ++ it) {
+    _files[it->first].merge(it->second);
+  }
+  for (CounterMap::const_iterator it = other._options.begin(); it != other._options.end(); ++ it) {
+    _options[it->first].merge(it->second);
+  }
+  _strings += other._strings;
+  _stringBytes += other._stringBytes;
+}
+
+/// Dump all counters in JSON format
+void
+AppCmdParseStats::dump(std::ostream& out) const
+{
+  out << "{\n  \"total\": ";
+  ::printCounter(out, _total);
+  out << ",\n  \"failures\": " << _failures;
+  out << ",\n  \"phases\": {";
+  for (int i = 0; i != NPhases; ++ i) {
+    if (i) out << ",";
+    out << "\n    \"" << ::phaseNames[i] << "\": ";
+    ::printCounter(out, _phases[i]);
+  }
+  out << "\n  },\n  \"files\": ";
+  ::printCounters(out, _files);
+  out << ",\n  \"options\": ";
+  ::printCounters(out, _options);
+  out << ",\n  \"strings\": " << _strings;
+  out << ",\n  \"stringBytes\": " << _stringBytes;
+  out << "\n}\n";
+}
+
+/// Return name of the phase
+const char*
+AppCmdParseStats::phaseName(Phase phase)
+{
+  if (phase < 0 or phase >= NPhases) return "";
+  return ::phaseNames[phase];
+}
+
+/// Return current time in seconds from some arbitrary moment, monotonic
+double
+AppCmdParseStats::now()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+} // namespace AppUtils
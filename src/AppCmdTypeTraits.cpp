@@ -0,0 +1,414 @@
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Number conversion functions for AppCmdTypeTraits...
+//
+// Author List:
+//      Andy Salnikov
+//
+//------------------------------------------------------------------------
+
+//-----------------------
+// This Class's Header --
+//-----------------------
+#include "AppUtils/AppCmdTypeTraits.h"
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include <cmath>
+#include <limits>
+#include <locale>
+#include <sstream>
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+
+//-----------------------------------------------------------------------
+// Local Macros, Typedefs, Structures, Unions and Forward Declarations --
+//-----------------------------------------------------------------------
+
+namespace {
+
+// powers of ten which are exactly representable as double
+const double dpow10[] = {
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// powers of ten which are exactly representable as float
+const float fpow10[] = {
+  1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+};
+
+// white space skipped by strtol/strtod in "C" locale
+inline bool
+isSpace(char c)
+{
+  return c == ' ' or c == '\t' or c == '\n' or c == '\v' or c == '\f' or c == '\r';
+}
+
+// value of the digit in bases up to 16, returns 16 for non-digits
+inline unsigned
+digitValue(char c)
+{
+  if (c >= '0' and c <= '9') return c - '0';
+  if (c >= 'a' and c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' and c <= 'F') return c - 'A' + 10;
+  return 16;
+}
+
+// case-insensitive comparison of the range with lower-case word
+bool
+equalNoCase(const char* begin, const char* end, const char* word)
+{
+  for ( ; begin != end; ++ begin, ++ word) {
+    if (*word == '\0') return false;
+    char c = *begin;
+    if (c >= 'A' and c <= 'Z') c += 'a' - 'A';
+    if (c != *word) return false;
+  }
+  return *word == '\0';
+}
+
+// decimal floating point number split into parts
+struct Decimal {
+  unsigned long long mantissa;  // first 19 significant digits
+  int exponent;                 // decimal exponent applied to mantissa
+  bool exact;                   // false if some non-zero digits did not fit into mantissa
+  bool zero;                    // true if all digits are zeros
+};
+
+// Parse decimal floating point number "[digits][.digits][e[sign]digits]",
+// sign and leading blanks must be removed already. Returns false if string
+// is not a valid decimal number.
+bool
+scanDecimal(const char* p, const char* const end, Decimal& dec)
+{
+  const unsigned maxDigits = 19;
+  unsigned long long mantissa = 0;
+  unsigned nDigits = 0;         // significant digits stored in mantissa
+  int exponent = 0;
+  bool exact = true;
+  bool anyDigits = false;
+  bool zero = true;
+
+  // integer part
+  for ( ; p != end and *p >= '0' and *p <= '9'; ++ p) {
+    anyDigits = true;
+    const unsigned d = *p - '0';
+    if (d != 0) zero = false;
+    if (nDigits < maxDigits) {
+      mantissa = mantissa * 10 + d;
+      if (mantissa != 0) ++ nDigits;
+    } else {
+      ++ exponent;
+      if (d != 0) exact = false;
+    }
+  }
+
+  // fraction part
+  if (p != end and *p == '.') {
+    for (++ p; p != end and *p >= '0' and *p <= '9'; ++ p) {
+      anyDigits = true;
+      const unsigned d = *p - '0';
+      if (d != 0) zero = false;
+      if (nDigits < maxDigits) {
+        mantissa = mantissa * 10 + d;
+        if (mantissa != 0) ++ nDigits;
+        -- exponent;
+      } else {
+        if (d != 0) exact = false;
+      }
+    }
+  }
+  if (not anyDigits) return false;
+
+  // exponent
+  if (p != end and (*p == 'e' or *p == 'E')) {
+    ++ p;
+    bool negExp = false;
+    if (p != end and (*p == '+' or *p == '-')) {
+      negExp = *p == '-';
+      ++ p;
+    }
+    if (p == end) return false;
+    int exp = 0;
+    for ( ; p != end and *p >= '0' and *p <= '9'; ++ p) {
+      // large exponents are clipped, they overflow or underflow anyway
+      if (exp < 100000) exp = exp * 10 + (*p - '0');
+    }
+    exponent += negExp ? -exp : exp;
+  }
+
+  if (p != end) return false;
+
+  dec.mantissa = mantissa;
+  dec.exponent = exponent;
+  dec.exact = exact;
+  dec.zero = zero;
+  return true;
+}
+
+// Parse hexadecimal floating point number "[hexdigits][.hexdigits][p[sign]digits]",
+// sign, leading blanks and 0x prefix must be removed already. Value is
+// mantissa * 2^exponent, mantissa keeps 15 significant hex digits and lowest
+// bit is set if any dropped digit is non-zero, this is enough for correct
+// rounding to double. Returns false if string is not a valid number.
+bool
+scanHex(const char* p, const char* const end, unsigned long long& mantissa, int& exponent)
+{
+  const unsigned maxDigits = 15;
+  unsigned long long m = 0;
+  unsigned nDigits = 0;
+  int exp = 0;
+  bool sticky = false;
+  bool anyDigits = false;
+
+  // integer part
+  for ( ; p != end; ++ p) {
+    const unsigned d = ::digitValue(*p);
+    if (d >= 16) break;
+    anyDigits = true;
+    if (nDigits < maxDigits) {
+      m = m * 16 + d;
+      if (m != 0) ++ nDigits;
+    } else {
+      exp += 4;
+      if (d != 0) sticky = true;
+    }
+  }
+
+  // fraction part
+  if (p != end and *p == '.') {
+    for (++ p; p != end; ++ p) {
+      const unsigned d = ::digitValue(*p);
+      if (d >= 16) break;
+      anyDigits = true;
+      if (nDigits < maxDigits) {
+        m = m * 16 + d;
+        if (m != 0) ++ nDigits;
+        exp -= 4;
+      } else {
+        if (d != 0) sticky = true;
+      }
+    }
+  }
+  if (not anyDigits) return false;
+
+  // binary exponent
+  if (p != end and (*p == 'p' or *p == 'P')) {
+    ++ p;
+    bool negExp = false;
+    if (p != end and (*p == '+' or *p == '-')) {
+      negExp = *p == '-';
+      ++ p;
+    }
+    if (p == end) return false;
+    int bexp = 0;
+    for ( ; p != end and *p >= '0' and *p <= '9'; ++ p) {
+      // large exponents are clipped, they overflow or underflow anyway
+      if (bexp < 100000) bexp = bexp * 10 + (*p - '0');
+    }
+    exp += negExp ? -bexp : bexp;
+  }
+
+  if (p != end) return false;
+
+  mantissa = sticky ? (m | 1) : m;
+  exponent = exp;
+  return true;
+}
+
+// Make floating point number mantissa * 2^exponent with correct rounding,
+// returns false on overflow or underflow to zero.
+template <typename T>
+bool
+composeBinary(unsigned long long mantissa, int exponent, T& val)
+{
+  const int digits = std::numeric_limits<T>::digits;
+  const int minExp = std::numeric_limits<T>::min_exponent - 1;
+
+  // exponent of the highest bit
+  int top = exponent - 1;
+  for (unsigned long long m = mantissa; m != 0; m >>= 1) ++ top;
+
+  if (top >= minExp) {
+    // normal number, conversion from integer rounds once, ldexp is exact
+    // or overflows to infinity
+    val = std::ldexp(T(mantissa), exponent);
+    return val <= std::numeric_limits<T>::max();
+  }
+
+  // subnormal number, round to the multiple of the smallest subnormal here,
+  // so that ldexp is exact
+  const int unitExp = minExp - digits + 1;
+  const int shift = unitExp - exponent;
+  unsigned long long res = 0;
+  if (shift <= 0) {
+    // all bits fit
+    val = std::ldexp(T(mantissa), exponent);
+    return true;
+  } else if (shift < 64) {
+    res = mantissa >> shift;
+    const unsigned long long rest = mantissa & ((1ULL << shift) - 1);
+    const unsigned long long half = 1ULL << (shift - 1);
+    if (rest > half or (rest == half and (res & 1))) ++ res;
+  } else if (shift == 64) {
+    if (mantissa > (1ULL << 63)) res = 1;
+  }
+  if (res == 0) return false;
+  val = std::ldexp(T(res), unitExp);
+  return true;
+}
+
+// Convert number which cannot be converted exactly by the fast path,
+// uses stream with the classic locale which gives correctly rounded result.
+template <typename T>
+bool
+slowConvert(const char* begin, const char* end, T& val)
+{
+  std::istringstream str(std::string(begin, end));
+  str.imbue(std::locale::classic());
+  str >> val;
+  return not str.fail() and str.get() == std::istringstream::traits_type::eof();
+}
+
+// common part of the floating point conversion
+template <typename T>
+bool
+strToFloat(const char* p, const char* end, T& val, unsigned long long maxMantissa, int maxExp, const T* pow10)
+{
+  while (p != end and isSpace(*p)) ++ p;
+  const char* const start = p;
+  bool negative = false;
+  if (p != end and (*p == '+' or *p == '-')) {
+    negative = *p == '-';
+    ++ p;
+  }
+  if (p == end) return false;
+
+  // special values
+  if (*p == 'i' or *p == 'I' or *p == 'n' or *p == 'N') {
+    if (equalNoCase(p, end, "inf") or equalNoCase(p, end, "infinity")) {
+      val = negative ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::infinity();
+      return true;
+    }
+    if (equalNoCase(p, end, "nan") or
+        (end - p > 4 and equalNoCase(p, p + 4, "nan(") and *(end - 1) == ')')) {
+      val = std::numeric_limits<T>::quiet_NaN();
+      return true;
+    }
+    return false;
+  }
+
+  Decimal dec;
+  if (not scanDecimal(p, end, dec)) {
+    unsigned long long mantissa;
+    int exponent;
+    if (end - p > 2 and p[0] == '0' and (p[1] == 'x' or p[1] == 'X') and
+        ::scanHex(p + 2, end, mantissa, exponent)) {
+      if (mantissa == 0) {
+        val = negative ? -T(0) : T(0);
+        return true;
+      }
+      if (not ::composeBinary(mantissa, exponent, val)) return false;
+      if (negative) val = -val;
+      return true;
+    }
+    return false;
+  }
+
+  if (dec.zero) {
+    val = negative ? -T(0) : T(0);
+    return true;
+  }
+
+  // fast path: mantissa and power of ten are both exact, then one
+  // multiplication or division gives correctly rounded result
+  if (dec.exact and dec.mantissa <= maxMantissa and dec.exponent >= -maxExp and dec.exponent <= maxExp) {
+    T res = T(dec.mantissa);
+    if (dec.exponent < 0) {
+      res /= pow10[-dec.exponent];
+    } else {
+      res *= pow10[dec.exponent];
+    }
+    val = negative ? -res : res;
+    return true;
+  }
+
+  // stream fails on overflow, underflow to zero has to be checked here
+  if (not ::slowConvert(start, end, val)) return false;
+  return val != T(0);
+}
+
+}
+
+//		----------------------------------------
+// 		-- Public Function Member Definitions --
+//		----------------------------------------
+
+namespace AppUtils {
+namespace detail {
+
+// Parse integer number with the same syntax as strtoull with base 0.
+bool
+scanInteger(const char* p, const char* end, bool& negative, unsigned long long& magnitude)
+{
+  while (p != end and isSpace(*p)) ++ p;
+  negative = false;
+  if (p != end and (*p == '+' or *p == '-')) {
+    negative = *p == '-';
+    ++ p;
+  }
+  if (p == end) return false;
+
+  unsigned base = 10;
+  if (*p == '0') {
+    ++ p;
+    if (p == end) {
+      magnitude = 0;
+      return true;
+    }
+    if (*p == 'x' or *p == 'X') {
+      base = 16;
+      ++ p;
+      if (p == end) return false;
+    } else {
+      base = 8;
+    }
+  }
+
+  const unsigned long long maxVal = std::numeric_limits<unsigned long long>::max();
+  const unsigned long long cutoff = maxVal / base;
+  const unsigned cutlim = maxVal % base;
+  unsigned long long val = 0;
+  for ( ; p != end; ++ p) {
+    const unsigned d = ::digitValue(*p);
+    if (d >= base) return false;
+    if (val > cutoff or (val == cutoff and d > cutlim)) return false;
+    val = val * base + d;
+  }
+
+  magnitude = val;
+  return true;
+}
+
+// Convert string to floating point number with the same syntax as strtod.
+bool
+strToFloat(const char* begin, const char* end, double& val)
+{
+  return ::strToFloat(begin, end, val, 1ULL << 53, 22, ::dpow10);
+}
+
+bool
+strToFloat(const char* begin, const char* end, float& val)
+{
+  return ::strToFloat(begin, end, val, 1ULL << 24, 10, ::fpow10);
+}
+
+} // namespace detail
+} // namespace AppUtils
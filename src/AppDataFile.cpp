@@ -0,0 +1,238 @@
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Class AppDataFile...
+//
+// Author List:
+//      Andy Salnikov
+//
+//------------------------------------------------------------------------
+
+//-----------------------
+// This Class's Header --
+//-----------------------
+#include "AppUtils/AppDataFile.h"
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include <stdlib.h>
+#include <map>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <boost/filesystem.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/weak_ptr.hpp>
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+#include "AppUtils/AppDataPath.h"
+#include "AppUtils/AppFileStamp.h"
+
+//-----------------------------------------------------------------------
+// Local Macros, Typedefs, Structures, Unions and Forward Declarations --
+//-----------------------------------------------------------------------
+
+namespace {
+
+// returns canonical path of existing file or empty string
+std::string
+canonicalPath(const std::string& path)
+{
+  if (path.empty()) return std::string();
+  char* res = ::realpath(path.c_str(), 0);
+  if (not res) return std::string();
+  const std::string str(res);
+  ::free(res);
+  return str;
+}
+
+// returns path of the file in $SIT_DATA or empty string if it cannot be found
+std::string
+findData(const std::string& relPath)
+{
+  try {
+    return AppUtils::AppDataPath(relPath).path();
+  } catch (const boost::filesystem::filesystem_error&) {
+    return std::string();
+  }
+}
+
+}
+
+//		----------------------------------------
+// 		-- Public Function Member Definitions --
+//		----------------------------------------
+
+namespace AppUtils {
+
+// one mapped file, unmapped when last instance referring to it is gone
+class AppDataFile::Mapping {
+public:
+
+  // returns zero if file cannot be mapped
+  static Mapping* open(const std::string& path, const AppFileStamp& stamp) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return 0;
+
+    struct stat st;
+    void* addr = MAP_FAILED;
+    bool ok = ::fstat(fd, &st) == 0 and S_ISREG(st.st_mode);
+    if (ok and st.st_size > 0) {
+      addr = ::mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+      ok = addr != MAP_FAILED;
+    }
+    ::close(fd);
+    if (not ok) return 0;
+
+    // empty files cannot be mapped, they refer to an empty string
+    if (addr == MAP_FAILED) return new Mapping(path, stamp, "", 0);
+    return new Mapping(path, stamp, static_cast<const char*>(addr), st.st_size);
+  }
+
+  ~Mapping() { if (m_size) ::munmap(const_cast<char*>(m_data), m_size); }
+
+  const std::string& path() const { return m_path; }
+  const AppFileStamp& stamp() const { return m_stamp; }
+  const char* data() const { return m_data; }
+  size_t size() const { return m_size; }
+
+  // process-wide mappings, key is canonical path; registry does not keep
+  // mappings alive, entries of unmapped files are removed when registry is used
+  struct Registry {
+    typedef std::map<std::string, boost::weak_ptr<const Mapping> > Map;
+
+    // remove entries of unmapped files
+    void prune() {
+      for (Map::iterator it = mappings.begin(); it != mappings.end(); ) {
+        if (it->second.expired()) {
+          mappings.erase(it ++);
+        } else {
+          ++ it;
+        }
+      }
+    }
+
+    boost::mutex mutex;
+    Map mappings;
+  };
+
+  static Registry& registry() {
+    static Registry registry;
+    return registry;
+  }
+
+private:
+
+  Mapping(const std::string& path, const AppFileStamp& stamp, const char* data, size_t size)
+    : m_path(path), m_stamp(stamp), m_data(data), m_size(size) {}
+
+  std::string m_path;
+  AppFileStamp m_stamp;  // file stamp before it was mapped
+  const char* m_data;
+  size_t m_size;
+
+  // This class is non-copyable
+  Mapping(const Mapping&);
+  Mapping& operator=(const Mapping&);
+};
+
+//----------------
+// Constructors --
+//----------------
+AppDataFile::AppDataFile(const std::string& relPath)
+  : m_mapping(map(::findData(relPath)))
+{
+}
+
+AppDataFile::AppDataFile()
+  : m_mapping()
+{
+}
+
+// Map file with the given path, not relative to $SIT_DATA
+AppDataFile
+AppDataFile::open(const std::string& path)
+{
+  AppDataFile file;
+  file.m_mapping = map(path);
+  return file;
+}
+
+// Returns canonical path of the mapped file or empty string
+const std::string&
+AppDataFile::path() const
+{
+  static const std::string empty;
+  return m_mapping ? m_mapping->path() : empty;
+}
+
+// Returns pointer to the file contents, never null
+const char*
+AppDataFile::data() const
+{
+  return m_mapping ? m_mapping->data() : "";
+}
+
+// Returns size of the file contents
+size_t
+AppDataFile::size() const
+{
+  return m_mapping ? m_mapping->size() : 0;
+}
+
+// Returns number of files currently mapped in this process
+unsigned long
+AppDataFile::mappedFiles()
+{
+  Mapping::Registry& reg = Mapping::registry();
+  boost::mutex::scoped_lock lock(reg.mutex);
+  reg.prune();
+  return reg.mappings.size();
+}
+
+// find or make mapping for the file
+boost::shared_ptr<const AppDataFile::Mapping>
+AppDataFile::map(const std::string& path)
+{
+  boost::shared_ptr<const Mapping> mapping;
+
+  const std::string canonical = ::canonicalPath(path);
+  AppFileStamp stamp;
+  if (canonical.empty() or not AppFileStamp::get(canonical, stamp)) return mapping;
+
+  Mapping::Registry& reg = Mapping::registry();
+  {
+    boost::mutex::scoped_lock lock(reg.mutex);
+    Mapping::Registry::Map::iterator it = reg.mappings.find(canonical);
+    if (it != reg.mappings.end()) {
+      mapping = it->second.lock();
+      // file changed since it was mapped, existing users keep old mapping,
+      // which only has old contents if file was replaced and not rewritten
+      if (mapping and mapping->stamp() == stamp) return mapping;
+    }
+  }
+
+  // open and map the file without the lock, opening may be slow on network
+  // file systems and should not block mapping of other files
+  mapping.reset(Mapping::open(canonical, stamp));
+  if (not mapping) return mapping;
+
+  boost::mutex::scoped_lock lock(reg.mutex);
+  Mapping::Registry::Map::iterator it = reg.mappings.find(canonical);
+  if (it != reg.mappings.end()) {
+    // other thread could map the same file meanwhile, use its mapping then
+    boost::shared_ptr<const Mapping> other = it->second.lock();
+    if (other and other->stamp() == stamp) return other;
+  }
+  reg.prune();
+  reg.mappings[canonical] = mapping;
+  return mapping;
+}
+
+} // namespace AppUtils
@@ -19,8 +19,22 @@
 // C/C++ Headers --
 //-----------------
 #include <stdlib.h>
+#include <algorithm>
+#include <cerrno>
+#include <map>
+#include <vector>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <boost/algorithm/string.hpp>
 #include <boost/filesystem.hpp>
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
 
 //-------------------------------
 // Collaborating Class Headers --
@@ -32,12 +46,323 @@
 
 namespace fs = boost::filesystem;
 
+namespace {
+
+// answer of the directory index
+enum Answer { Missing, Present, Unknown };
+
+// split relative path into components, returns false for empty or absolute
+// paths, paths with trailing slash (which only exist if they are directories)
+// and paths with "." or ".." which have to be checked with stat()
+bool
+splitRelPath(const std::string& relPath, std::vector<std::string>& parts)
+{
+  if (relPath.empty() or relPath[0] == '/' or relPath[relPath.size()-1] == '/') return false;
+  boost::split(parts, relPath, boost::is_any_of("/"), boost::token_compress_on);
+  for (std::vector<std::string>::const_iterator it = parts.begin(); it != parts.end(); ++ it) {
+    if (*it == "." or *it == "..") return false;
+  }
+  return true;
+}
+
+// directory in the index of $SIT_DATA roots, it is read when first needed
+struct DirNode {
+  struct Entry {
+    Entry() : type(DT_UNKNOWN), dir() {}
+    unsigned char type;                 // d_type from readdir()
+    boost::shared_ptr<DirNode> dir;     // made when entry is used as directory
+  };
+  DirNode() : loaded(false), listable(false), entries() {}
+  bool loaded;
+  bool listable;    // false if directory exists but cannot be read
+  std::map<std::string, Entry> entries;
+};
+
+// Index of $SIT_DATA roots built from directory listings. Every directory on
+// the way to a file is read once and all following lookups in the same
+// directory do not access file system. Paths with "." or ".." and entries
+// which are symlinks or of unknown type are not answered by index. Directories
+// are read without holding the lock so that many threads can read different
+// directories at the same time.
+class DirIndex {
+public:
+
+  DirIndex() : m_mutex(), m_roots(), m_listings(0) {}
+
+  Answer lookup(const std::string& root, const std::vector<std::string>& parts) {
+    boost::mutex::scoped_lock lock(m_mutex);
+    boost::shared_ptr<DirNode>& rootNode = m_roots[root];
+    if (not rootNode) rootNode.reset(new DirNode);
+    boost::shared_ptr<DirNode> node = rootNode;
+    std::string dir = root.empty() ? std::string(".") : root;
+    for (size_t i = 0; i != parts.size(); ++ i) {
+      if (not node->loaded) {
+        // other thread may read the same directory meanwhile, first one wins
+        lock.unlock();
+        DirNode listing;
+        read(listing, dir);
+        lock.lock();
+        ++ m_listings;
+        if (not node->loaded) {
+          node->entries.swap(listing.entries);
+          node->listable = listing.listable;
+          node->loaded = true;
+        }
+      }
+      if (not node->listable) return Unknown;
+
+      std::map<std::string, DirNode::Entry>::iterator it = node->entries.find(parts[i]);
+      if (it == node->entries.end()) return Missing;
+      DirNode::Entry& entry = it->second;
+      if (i + 1 == parts.size()) {
+        // symlink may be dangling
+        return entry.type == DT_LNK or entry.type == DT_UNKNOWN ? Unknown : Present;
+      }
+      if (entry.type != DT_DIR and entry.type != DT_LNK and entry.type != DT_UNKNOWN) return Missing;
+
+      if (not entry.dir) entry.dir.reset(new DirNode);
+      node = entry.dir;
+      dir += '/';
+      dir += parts[i];
+    }
+    return Unknown;
+  }
+
+  void clear() {
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_roots.clear();
+    m_listings = 0;
+  }
+
+  unsigned long long listings() {
+    boost::mutex::scoped_lock lock(m_mutex);
+    return m_listings;
+  }
+
+private:
+
+  static void read(DirNode& node, const std::string& dir) {
+    node.loaded = true;
+    DIR* dirp = ::opendir(dir.c_str());
+    if (not dirp) {
+      // missing directory is known to have no files, other errors need stat()
+      node.listable = errno == ENOENT or errno == ENOTDIR;
+      return;
+    }
+    node.listable = true;
+    while (const struct dirent* de = ::readdir(dirp)) {
+      const std::string name(de->d_name);
+      if (name == "." or name == "..") continue;
+#ifdef _DIRENT_HAVE_D_TYPE
+      node.entries[name].type = de->d_type;
+#else
+      node.entries[name].type = DT_UNKNOWN;
+#endif
+    }
+    ::closedir(dirp);
+  }
+
+  boost::mutex m_mutex;
+  std::map<std::string, boost::shared_ptr<DirNode> > m_roots;
+  unsigned long long m_listings;
+};
+
+// Manifest of $SIT_DATA root, sorted list of all files and directories in
+// the root, one relative path per line after the header line. File is
+// memory-mapped and searched in place with binary search.
+class Manifest {
+public:
+
+  // returns zero if root has no manifest or it is not valid
+  static Manifest* open(const std::string& root) {
+    const std::string path = (root.empty() ? std::string(".") : root) + "/" + AppUtils::AppDataPath::manifestName;
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return 0;
+
+    struct stat st;
+    void* addr = MAP_FAILED;
+    if (::fstat(fd, &st) == 0 and st.st_size > 0) {
+      addr = ::mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (addr == MAP_FAILED) return 0;
+
+    // header and complete last line are required
+    const char* data = static_cast<const char*>(addr);
+    const size_t size = st.st_size;
+    const size_t hsize = std::strlen(header);
+    if (size < hsize or std::memcmp(data, header, hsize) != 0 or data[size-1] != '\n') {
+      ::munmap(addr, size);
+      return 0;
+    }
+    return new Manifest(data, size, hsize);
+  }
+
+  ~Manifest() { ::munmap(const_cast<char*>(m_data), m_size); }
+
+  bool contains(const std::string& key) const {
+    const char* lo = m_data + m_begin;
+    const char* hi = m_data + m_size;
+    while (lo < hi) {
+      // line which contains the middle byte
+      const char* line = lo + (hi - lo) / 2;
+      while (line > lo and line[-1] != '\n') -- line;
+      const char* eol = static_cast<const char*>(std::memchr(line, '\n', hi - line));
+
+      const size_t len = eol - line;
+      int cmp = std::memcmp(line, key.data(), std::min(len, key.size()));
+      if (cmp == 0) cmp = len < key.size() ? -1 : (len > key.size() ? 1 : 0);
+      if (cmp == 0) return true;
+      if (cmp < 0) {
+        lo = eol + 1;
+      } else {
+        hi = line;
+      }
+    }
+    return false;
+  }
+
+  static const char* const header;
+
+private:
+
+  Manifest(const char* data, size_t size, size_t begin) : m_data(data), m_size(size), m_begin(begin) {}
+
+  const char* m_data;
+  size_t m_size;
+  size_t m_begin;    // offset of the first path
+
+  // This class is non-copyable
+  Manifest(const Manifest&);
+  Manifest& operator=(const Manifest&);
+};
+
+const char* const Manifest::header = "AppDataPath-manifest 1\n";
+
+// manifests of $SIT_DATA roots, zero for roots without manifest
+class Manifests {
+public:
+
+  Manifests() : m_mutex(), m_manifests() {}
+
+  boost::shared_ptr<const Manifest> get(const std::string& root) {
+    boost::mutex::scoped_lock lock(m_mutex);
+    std::map<std::string, boost::shared_ptr<const Manifest> >::iterator it = m_manifests.find(root);
+    if (it == m_manifests.end()) {
+      it = m_manifests.insert(std::make_pair(root, boost::shared_ptr<const Manifest>(Manifest::open(root)))).first;
+    }
+    return it->second;
+  }
+
+  void clear() {
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_manifests.clear();
+  }
+
+private:
+  boost::mutex m_mutex;
+  std::map<std::string, boost::shared_ptr<const Manifest> > m_manifests;
+};
+
+// process-wide cache of resolved paths, empty path means file was not found
+struct PathCache {
+  boost::mutex mutex;
+  std::string dataPath;     // value of $SIT_DATA for which paths were resolved
+  std::map<std::string, std::string> paths;
+  AppUtils::AppDataPath::CacheStats stats;
+  DirIndex index;           // listings of $SIT_DATA directories
+  Manifests manifests;      // manifests of $SIT_DATA roots
+};
+
+PathCache&
+pathCache()
+{
+  static PathCache cache;
+  return cache;
+}
+
+// relative path prepared for lookups
+struct RelPath {
+  explicit RelPath(const std::string& path_) : path(path_), parts(), normal(::splitRelPath(path_, parts)), key() {
+    // normalized path is used for manifests and directory index
+    if (normal) key = boost::join(parts, "/");
+  }
+  std::string path;
+  std::vector<std::string> parts;
+  bool normal;
+  std::string key;
+};
+
+// returns path of the file in one $SIT_DATA directory or empty string if it is not there
+std::string
+findInRoot(const std::string& root, const RelPath& relPath)
+{
+  PathCache& cache = ::pathCache();
+  fs::path path = root;
+  path /= relPath.path;
+
+  // roots with manifest are never checked directly
+  if (relPath.normal) {
+    if (boost::shared_ptr<const Manifest> manifest = cache.manifests.get(root)) {
+      return manifest->contains(relPath.key) ? path.string() : std::string();
+    }
+  }
+
+  switch (relPath.normal ? cache.index.lookup(root, relPath.parts) : Unknown) {
+  case Present:
+    return path.string();
+  case Missing:
+    break;
+  case Unknown:
+    if (fs::exists(path)) return path.string();
+    break;
+  }
+  return std::string();
+}
+
+// find first existing file in $SIT_DATA directories
+std::string
+resolve(const std::string& dataPath, const std::string& relPath)
+{
+  // split SIT_DATA path on :
+  std::list<std::string> paths;
+  boost::split(paths, dataPath, boost::is_any_of(":"));
+
+  const RelPath rel(relPath);
+  for (std::list<std::string>::const_iterator it = paths.begin(); it != paths.end(); ++ it) {
+    const std::string path = ::findInRoot(*it, rel);
+    if (not path.empty()) return path;
+  }
+  return std::string();
+}
+
+// look up every step-th pending path in one root, used by batch resolve. Errors
+// are kept for every path and not thrown as this also runs in other threads.
+void
+findRange(const std::string& root, const std::vector<RelPath>& rels, const std::vector<size_t>& pending,
+    std::vector<std::string>& found, std::vector<boost::shared_ptr<fs::filesystem_error> >& errors,
+    size_t first, size_t step)
+{
+  for (size_t k = first; k < pending.size(); k += step) {
+    const size_t i = pending[k];
+    try {
+      found[i] = ::findInRoot(root, rels[i]);
+    } catch (const fs::filesystem_error& ex) {
+      errors[i].reset(new fs::filesystem_error(ex));
+    }
+  }
+}
+
+}
+
 //		----------------------------------------
 // 		-- Public Function Member Definitions --
 //		----------------------------------------
 
 namespace AppUtils {
 
+const char* const AppDataPath::manifestName = ".AppDataPath.manifest";
+
 //----------------
 // Constructors --
 //----------------
@@ -48,22 +373,153 @@ AppDataPath::AppDataPath(const std::string& relPath)
   const char* dataPath = getenv("SIT_DATA");
   if (not dataPath) return;
 
+  PathCache& cache = ::pathCache();
+  {
+    boost::mutex::scoped_lock lock(cache.mutex);
+    if (cache.dataPath != dataPath) {
+      cache.paths.clear();
+      cache.dataPath = dataPath;
+    }
+    std::map<std::string, std::string>::const_iterator it = cache.paths.find(relPath);
+    if (it != cache.paths.end()) {
+      ++ cache.stats.hits;
+      m_path = it->second;
+      return;
+    }
+    ++ cache.stats.misses;
+  }
+
+  // file system is not accessed while holding the lock
+  m_path = ::resolve(dataPath, relPath);
+
+  boost::mutex::scoped_lock lock(cache.mutex);
+  if (cache.dataPath == dataPath) cache.paths.insert(std::make_pair(relPath, m_path));
+}
+
+// Resolve many relative paths at once.
+std::vector<std::string>
+AppDataPath::resolve(const std::vector<std::string>& relPaths, unsigned nThreads)
+{
+  std::vector<std::string> result(relPaths.size());
+  const char* dataPath = getenv("SIT_DATA");
+  if (not dataPath) return result;
+
+  // answer what is known already, collect other paths without duplicates
+  PathCache& cache = ::pathCache();
+  std::map<std::string, size_t> missIndex;
+  std::vector<RelPath> rels;
+  {
+    boost::mutex::scoped_lock lock(cache.mutex);
+    if (cache.dataPath != dataPath) {
+      cache.paths.clear();
+      cache.dataPath = dataPath;
+    }
+    for (size_t i = 0; i != relPaths.size(); ++ i) {
+      std::map<std::string, std::string>::const_iterator it = cache.paths.find(relPaths[i]);
+      if (it != cache.paths.end()) {
+        ++ cache.stats.hits;
+        result[i] = it->second;
+      } else if (missIndex.insert(std::make_pair(relPaths[i], rels.size())).second) {
+        ++ cache.stats.misses;
+        rels.push_back(RelPath(relPaths[i]));
+      } else {
+        // same path is looked up once
+        ++ cache.stats.hits;
+      }
+    }
+  }
+  if (rels.empty()) return result;
+
   // split SIT_DATA path on :
-  std::list<std::string> paths;
-  boost::split(paths, dataPath, boost::is_any_of(":"));
+  std::list<std::string> roots;
+  boost::split(roots, dataPath, boost::is_any_of(":"));
 
-  // find first existing file
-  for (std::list<std::string>::const_iterator it = paths.begin(); it != paths.end(); ++ it) {
+  // check one root for all paths not found yet, lookups in one root run in parallel
+  std::vector<std::string> found(rels.size());
+  std::vector<std::string> paths(rels.size());
+  std::vector<boost::shared_ptr<fs::filesystem_error> > errors(rels.size());
+  std::vector<size_t> pending;
+  for (size_t i = 0; i != rels.size(); ++ i) pending.push_back(i);
+  for (std::list<std::string>::const_iterator root = roots.begin(); root != roots.end() and not pending.empty(); ++ root) {
 
-    fs::path path = *it;
-    path /= relPath;
+    size_t nThr = nThreads ? nThreads : 16;
+    if (nThr > pending.size()) nThr = pending.size();
+    if (nThr <= 1) {
+      ::findRange(*root, rels, pending, found, errors, 0, 1);
+    } else {
+      // current thread does its share too, other threads use our locals so
+      // they are always joined
+      boost::thread_group threads;
+      try {
+        for (size_t t = 1; t != nThr; ++ t) {
+          threads.create_thread(boost::bind(&::findRange, boost::cref(*root), boost::cref(rels), boost::cref(pending),
+              boost::ref(found), boost::ref(errors), t, nThr));
+        }
+        ::findRange(*root, rels, pending, found, errors, 0, nThr);
+      } catch (...) {
+        threads.join_all();
+        throw;
+      }
+      threads.join_all();
+    }
+
+    // paths with errors are not looked up in the following roots
+    std::vector<size_t> left;
+    for (std::vector<size_t>::const_iterator it = pending.begin(); it != pending.end(); ++ it) {
+      if (errors[*it]) continue;
+      if (found[*it].empty()) {
+        left.push_back(*it);
+      } else {
+        paths[*it].swap(found[*it]);
+      }
+    }
+    pending.swap(left);
+  }
 
-    if (fs::exists(path)) {
-      m_path = path.string();
-      break;
+  {
+    boost::mutex::scoped_lock lock(cache.mutex);
+    if (cache.dataPath == dataPath) {
+      for (size_t i = 0; i != rels.size(); ++ i) {
+        if (not errors[i]) cache.paths.insert(std::make_pair(rels[i].path, paths[i]));
+      }
     }
+  }
+
+  // throw the same error as constructor for the first failed path
+  for (size_t i = 0; i != rels.size(); ++ i) {
+    if (errors[i]) throw *errors[i];
+  }
 
+  for (size_t i = 0; i != relPaths.size(); ++ i) {
+    std::map<std::string, size_t>::const_iterator it = missIndex.find(relPaths[i]);
+    if (it != missIndex.end()) result[i] = paths[it->second];
   }
+  return result;
+}
+
+// Returns counters of the process-wide cache
+AppDataPath::CacheStats
+AppDataPath::cacheStats()
+{
+  PathCache& cache = ::pathCache();
+  boost::mutex::scoped_lock lock(cache.mutex);
+  CacheStats stats = cache.stats;
+  stats.size = cache.paths.size();
+  stats.listings = cache.index.listings();
+  return stats;
+}
+
+// Forget all resolved paths and reset counters
+void
+AppDataPath::clearCache()
+{
+  PathCache& cache = ::pathCache();
+  boost::mutex::scoped_lock lock(cache.mutex);
+  cache.paths.clear();
+  cache.dataPath.clear();
+  cache.stats = CacheStats();
+  cache.index.clear();
+  cache.manifests.clear();
 }
 
 } // namespace AppUtils
@@ -10,6 +10,10 @@
 """AppDataPath class represents a path to a file that can be found in
 one of the $SIT_DATA locations.
 
+$SIT_DATA directories which have a manifest (see writeManifest()) are not
+checked on disk, file is looked up in the manifest instead. Manifest format
+is the same as used by C++ AppDataPath class.
+
 @version $Id$
 
 @author Andy Salnikov
@@ -36,6 +40,81 @@ import os
 # Imports for other modules --
 #-----------------------------
 
+#----------------------------------
+# Local non-exported definitions --
+#----------------------------------
+
+# name of the manifest file and its first line
+MANIFEST_NAME = ".AppDataPath.manifest"
+_MANIFEST_HEADER = "AppDataPath-manifest 1"
+
+# manifests of $SIT_DATA directories, None for directories without manifest
+_manifests = {}
+
+def _manifest(dir):
+    """Returns set of paths from the manifest of directory or None"""
+    if dir not in _manifests:
+        manifest = None
+        try:
+            with open(os.path.join(dir or '.', MANIFEST_NAME)) as f:
+                data = f.read()
+            lines = data.split('\n')
+            # header and complete last line are required
+            if lines[0] == _MANIFEST_HEADER and data.endswith('\n'):
+                manifest = frozenset(lines[1:-1])
+        except (IOError, OSError):
+            pass
+        _manifests[dir] = manifest
+    return _manifests[dir]
+
+def _normalize(relPath):
+    """Returns relative path without redundant slashes or None if it cannot be looked up in manifest"""
+    # trailing slash only matches directories, it is left to os.path.exists()
+    if not relPath or relPath.startswith('/') or relPath.endswith('/'): return None
+    parts = [p for p in relPath.split('/') if p]
+    if '.' in parts or '..' in parts: return None
+    return '/'.join(parts)
+
+def writeManifest(dir):
+    """Write manifest of the directory which lists all its files and sub-directories.
+
+    Manifest is only valid while directory contents does not change, it should be
+    made for directories which do not change after installation. Symbolic links to
+    directories are followed (package directories in release areas are usually
+    symlinks), links which point back to one of their parent directories are
+    listed but not followed.
+    """
+    paths = []
+    # real paths of directories on the way from top to each directory being walked
+    parents = {dir: frozenset([os.path.realpath(dir)])}
+    for root, dirs, files in os.walk(dir, followlinks=True):
+        rel = os.path.relpath(root, dir)
+        for name in dirs + files:
+            path = name if rel == '.' else rel + '/' + name
+            if path != MANIFEST_NAME and os.path.exists(os.path.join(root, name)):
+                paths.append(path)
+
+        # do not descend into symlink cycles
+        chain = parents.pop(root)
+        subdirs = []
+        for name in dirs:
+            real = os.path.realpath(os.path.join(root, name))
+            if real not in chain:
+                parents[os.path.join(root, name)] = chain | frozenset([real])
+                subdirs.append(name)
+        dirs[:] = subdirs
+    paths.sort()
+
+    # write new file and rename it so that readers never see partial manifest
+    manifest = os.path.join(dir, MANIFEST_NAME)
+    tmp = "%s.%d" % (manifest, os.getpid())
+    with open(tmp, 'w') as f:
+        f.write(_MANIFEST_HEADER + '\n')
+        for path in paths:
+            f.write(path + '\n')
+    os.rename(tmp, manifest)
+    _manifests.pop(dir, None)
+
 #---------------------
 #  Class definition --
 #---------------------
@@ -53,10 +132,17 @@ class AppDataPath ( object ) :
         
         dataPath = os.getenv("SIT_DATA")
         if not dataPath: return
-            
+
+        key = _normalize(relPath)
         for dir in dataPath.split(':'):
             path = os.path.join(dir, relPath)
-            if os.path.exists(path):
+            manifest = _manifest(dir) if key else None
+            if manifest is not None:
+                # directories with manifest are not checked on disk
+                if key in manifest:
+                    self.m_path = path
+                    break
+            elif os.path.exists(path):
                 self.m_path = path
                 break
             
@@ -0,0 +1,49 @@
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Class AppFileStamp...
+//
+// Author List:
+//      Andy Salnikov
+//
+//------------------------------------------------------------------------
+
+//-----------------------
+// This Class's Header --
+//-----------------------
+#include "AppUtils/AppFileStamp.h"
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include <sys/stat.h>
+
+//		----------------------------------------
+// 		-- Public Function Member Definitions --
+//		----------------------------------------
+
+namespace AppUtils {
+
+// Make stamp from the result of stat()
+AppFileStamp::AppFileStamp(const struct stat& st)
+  : dev(st.st_dev)
+  , ino(st.st_ino)
+  , mtime(st.st_mtim.tv_sec)
+  , mtimeNsec(st.st_mtim.tv_nsec)
+  , size(st.st_size)
+{
+}
+
+// Get stamp of a file without reading it.
+bool
+AppFileStamp::get(const std::string& path, AppFileStamp& stamp)
+{
+  struct stat st;
+  if (::stat(path.c_str(), &st) != 0) return false;
+  stamp = AppFileStamp(st);
+  return true;
+}
+
+} // namespace AppUtils
@@ -0,0 +1,264 @@
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Class AppFileWatcher...
+//
+// Author List:
+//      Andy Salnikov
+//
+//------------------------------------------------------------------------
+
+//-----------------------
+// This Class's Header --
+//-----------------------
+#include "AppUtils/AppFileWatcher.h"
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+
+//-----------------------------------------------------------------------
+// Local Macros, Typedefs, Structures, Unions and Forward Declarations --
+//-----------------------------------------------------------------------
+
+namespace {
+
+// monotonic time in seconds
+double
+now()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// split path into directory and file name
+void
+splitPath(const std::string& path, std::string& dir, std::string& name)
+{
+  const std::string::size_type pos = path.rfind('/');
+  if (pos == std::string::npos) {
+    dir = ".";
+    name = path;
+  } else {
+    dir = pos == 0 ? std::string("/") : path.substr(0, pos);
+    name = path.substr(pos + 1);
+  }
+}
+
+#ifdef __linux__
+// events in directory which may change the file
+const uint32_t watchMask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE;
+#endif
+
+// interval for checking file stamps when inotify is not available
+const double pollInterval = 0.5;
+
+}
+
+//		----------------------------------------
+// 		-- Public Function Member Definitions --
+//		----------------------------------------
+
+namespace AppUtils {
+
+//----------------
+// Constructors --
+//----------------
+AppFileWatcher::AppFileWatcher(double coalesce)
+  : m_coalesce(coalesce)
+  , m_fd(-1)
+  , m_files()
+{
+#ifdef __linux__
+  m_fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+}
+
+//--------------
+// Destructor --
+//--------------
+AppFileWatcher::~AppFileWatcher()
+{
+  if (m_fd >= 0) ::close(m_fd);
+}
+
+// Add file to the set of watched files.
+bool
+AppFileWatcher::watch(const std::string& path)
+{
+  File file;
+  file.path = path;
+  file.wd = -1;
+
+  std::string dir;
+  ::splitPath(path, dir, file.name);
+  if (file.name.empty()) return false;
+
+#ifdef __linux__
+  if (m_fd >= 0) {
+    // watch for the same directory is shared by all its files
+    file.wd = ::inotify_add_watch(m_fd, dir.c_str(), ::watchMask);
+    if (file.wd < 0) return false;
+  }
+#endif
+  if (m_fd < 0) {
+    if (::access(dir.c_str(), F_OK) != 0) return false;
+    AppFileStamp::get(path, file.stamp);
+  }
+
+  m_files.push_back(file);
+  return true;
+}
+
+// Stop watching all files
+void
+AppFileWatcher::clear()
+{
+#ifdef __linux__
+  if (m_fd >= 0) {
+    // it is easier to start with new descriptor than to remove shared watches
+    ::close(m_fd);
+    m_fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  }
+#endif
+  m_files.clear();
+}
+
+// Returns list of watched files
+std::vector<std::string>
+AppFileWatcher::files() const
+{
+  std::vector<std::string> res;
+  for (std::vector<File>::const_iterator it = m_files.begin(); it != m_files.end(); ++ it) {
+    res.push_back(it->path);
+  }
+  return res;
+}
+
+// Wait for changes in the watched files.
+std::vector<std::string>
+AppFileWatcher::wait(double timeout)
+{
+  std::vector<std::string> res;
+  if (m_files.empty()) return res;
+
+  std::vector<bool> changed(m_files.size(), false);
+  if (not waitChanges(timeout, changed)) return res;
+
+  // collect the rest of the burst
+  const double limit = ::now() + 10 * m_coalesce;
+  for (double t = ::now(); t < limit; t = ::now()) {
+    const double interval = std::min(m_coalesce, limit - t);
+    if (not waitChanges(interval, changed)) break;
+  }
+
+  for (size_t i = 0; i != m_files.size(); ++ i) {
+    if (changed[i]) res.push_back(m_files[i].path);
+  }
+  return res;
+}
+
+// wait for events up to timeout seconds, returns true if any watched file changed
+bool
+AppFileWatcher::waitChanges(double timeout, std::vector<bool>& changed)
+{
+  const double deadline = timeout < 0 ? 0 : ::now() + timeout;
+  for (;;) {
+
+    double left = -1;
+    if (timeout >= 0) {
+      left = deadline - ::now();
+      if (left < 0) left = 0;
+    }
+
+    if (m_fd >= 0) {
+      struct pollfd pfd;
+      pfd.fd = m_fd;
+      pfd.events = POLLIN;
+      pfd.revents = 0;
+      const int ms = left < 0 ? -1 : int(left * 1000 + 0.999);
+      const int n = ::poll(&pfd, 1, ms);
+      if (n < 0 and errno != EINTR) return false;
+      // events in the same directory for other files do not count
+      if (n > 0 and readEvents(changed)) return true;
+    } else {
+      if (checkStamps(changed)) return true;
+      if (left == 0) return false;
+      const double sleep = left < 0 ? ::pollInterval : std::min(left, ::pollInterval);
+      ::usleep(useconds_t(sleep * 1e6));
+      if (checkStamps(changed)) return true;
+    }
+
+    if (timeout >= 0 and ::now() >= deadline) return false;
+  }
+}
+
+// read available inotify events, returns true if any watched file changed
+bool
+AppFileWatcher::readEvents(std::vector<bool>& changed)
+{
+  bool any = false;
+#ifdef __linux__
+  char buf[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+  for (;;) {
+    const ssize_t len = ::read(m_fd, buf, sizeof buf);
+    if (len <= 0) break;
+
+    for (const char* p = buf; p < buf + len; ) {
+      const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(p);
+      p += sizeof(struct inotify_event) + event->len;
+
+      if (event->mask & IN_Q_OVERFLOW) {
+        // events were lost, anything could have changed
+        changed.assign(changed.size(), true);
+        any = true;
+        continue;
+      }
+      if (event->len == 0) continue;
+
+      for (size_t i = 0; i != m_files.size(); ++ i) {
+        if (m_files[i].wd == event->wd and m_files[i].name == event->name) {
+          changed[i] = true;
+          any = true;
+        }
+      }
+    }
+  }
+#endif
+  return any;
+}
+
+// compare stamps of the files, returns true if any file changed
+bool
+AppFileWatcher::checkStamps(std::vector<bool>& changed)
+{
+  bool any = false;
+  for (size_t i = 0; i != m_files.size(); ++ i) {
+    AppFileStamp stamp;
+    AppFileStamp::get(m_files[i].path, stamp);
+    if (stamp != m_files[i].stamp) {
+      m_files[i].stamp = stamp;
+      changed[i] = true;
+      any = true;
+    }
+  }
+  return any;
+}
+
+} // namespace AppUtils
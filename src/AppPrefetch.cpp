@@ -0,0 +1,136 @@
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Class AppPrefetch...
+//
+// Author List:
+//      Andy Salnikov
+//
+//------------------------------------------------------------------------
+
+//-----------------------
+// This Class's Header --
+//-----------------------
+#include "AppUtils/AppPrefetch.h"
+
+//-----------------
+// C/C++ Headers --
+//-----------------
+#include <algorithm>
+#include <exception>
+#include <fcntl.h>
+#include <unistd.h>
+#include <boost/bind.hpp>
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+#include "AppUtils/AppDataPath.h"
+
+//-----------------------------------------------------------------------
+// Local Macros, Typedefs, Structures, Unions and Forward Declarations --
+//-----------------------------------------------------------------------
+
+namespace {
+
+// open file and ask kernel to start reading it
+void
+readAhead(const std::string& path)
+{
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) return;
+#ifdef POSIX_FADV_WILLNEED
+  ::posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+#endif
+  ::close(fd);
+}
+
+}
+
+//		----------------------------------------
+// 		-- Public Function Member Definitions --
+//		----------------------------------------
+
+namespace AppUtils {
+
+//----------------
+// Constructors --
+//----------------
+AppPrefetch::AppPrefetch()
+  : m_files()
+  , m_dataPaths()
+  , m_resolved()
+  , m_thread()
+{
+}
+
+//--------------
+// Destructor --
+//--------------
+AppPrefetch::~AppPrefetch()
+{
+  wait();
+}
+
+// Add file to read ahead, must be called before start()
+void
+AppPrefetch::addFile(const std::string& path)
+{
+  m_files.push_back(path);
+}
+
+// Add path relative to $SIT_DATA to resolve, must be called before start()
+void
+AppPrefetch::addDataPath(const std::string& relPath)
+{
+  m_dataPaths.push_back(relPath);
+}
+
+// Start background thread, does nothing if it was started already
+void
+AppPrefetch::start()
+{
+  if (m_thread) return;
+  m_thread.reset(new boost::thread(boost::bind(&AppPrefetch::run, this)));
+}
+
+// Wait until background thread finishes
+void
+AppPrefetch::wait()
+{
+  if (m_thread and m_thread->joinable()) m_thread->join();
+}
+
+// Returns path of the data file, same as AppDataPath(relPath).path().
+std::string
+AppPrefetch::dataPath(const std::string& relPath)
+{
+  // only paths resolved by background thread need to wait for it
+  if (m_thread and std::find(m_dataPaths.begin(), m_dataPaths.end(), relPath) != m_dataPaths.end()) {
+    wait();
+    std::map<std::string, std::string>::const_iterator it = m_resolved.find(relPath);
+    if (it != m_resolved.end()) return it->second;
+  }
+  return AppDataPath(relPath).path();
+}
+
+// body of the background thread
+void
+AppPrefetch::run()
+{
+  // options files are needed first
+  for (std::vector<std::string>::const_iterator it = m_files.begin(); it != m_files.end(); ++ it) {
+    ::readAhead(*it);
+  }
+  for (std::vector<std::string>::const_iterator it = m_dataPaths.begin(); it != m_dataPaths.end(); ++ it) {
+    try {
+      m_resolved[*it] = AppDataPath(*it).path();
+    } catch (const std::exception&) {
+      // dataPath() will try again and report the error
+    }
+  }
+}
+
+} // namespace AppUtils
@@ -19,8 +19,21 @@
 //---------------
 // C++ Headers --
 //---------------
+#include <algorithm>
 #include <string>
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/time.h>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
 
 //-------------------------------
 // Collaborating Class Headers --
@@ -31,11 +44,17 @@
 #include "AppUtils/AppCmdExceptions.h"
 #include "AppUtils/AppCmdOpt.h"
 #include "AppUtils/AppCmdOptBool.h"
+#include "AppUtils/AppCmdOptFile.h"
 #include "AppUtils/AppCmdOptIncr.h"
 #include "AppUtils/AppCmdOptList.h"
 #include "AppUtils/AppCmdOptSize.h"
 #include "AppUtils/AppCmdOptToggle.h"
 #include "AppUtils/AppCmdOptNamedValue.h"
+#include "AppUtils/AppCmdOptRangeList.h"
+#include "AppUtils/AppCmdParseResult.h"
+#include "AppUtils/AppCmdParseStats.h"
+#include "AppUtils/AppCmdTypeTraits.h"
+#include "AppUtils/AppFileWatcher.h"
 
 using namespace AppUtils ;
 
@@ -686,3 +705,1380 @@ BOOST_AUTO_TEST_CASE( cmdline_test_groups )
   BOOST_CHECK_EQUAL(optInt1.value(), 3);
   BOOST_CHECK_EQUAL(optInt2.value(), 4);
 }
+
+// ==============================================================
+
+BOOST_AUTO_TEST_CASE( cmdline_test_groups_added )
+{
+  // groups and options added between parses must be visible to parser
+  AppCmdLine cmdline( "command" ) ;
+  AppCmdOptIncr optVerbose(cmdline, "v,verbose", "make more noise", 0 );
+
+  const char* args[5] = { "" } ;
+
+  args[1] = "-v" ;
+  args[2] = "-x100" ;
+  BOOST_CHECK_THROW(cmdline.parse(3, args), AppCmdOptUnknownException);
+
+  AppCmdOptGroup group1(cmdline, "Input options");
+  AppCmdOpt<int> optInt1(group1, "x,number1", "number", "some number", 1 ) ;
+  BOOST_CHECK_NO_THROW(cmdline.parse(3, args));
+  BOOST_CHECK_EQUAL(optVerbose.value(), 1);
+  BOOST_CHECK_EQUAL(optInt1.value(), 100);
+
+  // conflicting name in a new group
+  AppCmdOptGroup group2(cmdline, "Output options");
+  AppCmdOpt<int> optInt2(group2, "y,number1", "number", "some number", 2 ) ;
+  BOOST_CHECK_THROW(cmdline.parse(3, args), AppCmdOptDefinedException);
+}
+
+// ==============================================================
+
+BOOST_AUTO_TEST_CASE( cmdline_test_optfile )
+{
+  char fname[] = "/tmp/AppCmdLineTest-XXXXXX";
+  int fd = mkstemp(fname);
+  BOOST_REQUIRE(fd >= 0);
+  close(fd);
+  {
+    std::ofstream out(fname);
+    out << "# comment line\n"
+        << "\n"
+        << "number1 = 100\n"
+        << "  number2=200  \n"
+        << "name = some string with spaces \n"
+        << "list = a,b\n"
+        << "list = c\n"
+        << "verbose\n";
+  }
+
+  AppCmdLine cmdline( "command" ) ;
+  AppCmdOptList<std::string> optFile(cmdline, "o,options", "path", "options file");
+  cmdline.setOptionsFile(optFile);
+  AppCmdOptIncr optVerbose(cmdline, "v,verbose", "make more noise", 0 );
+  AppCmdOpt<int> optInt1(cmdline, "x,number1", "number", "some number", 1 ) ;
+  AppCmdOpt<int> optInt2(cmdline, "y,number2", "number", "some number", 2 ) ;
+  AppCmdOpt<std::string> optName(cmdline, "name", "string", "some string", "" ) ;
+  AppCmdOptList<std::string> optList(cmdline, "l,list", "string", "list of strings" ) ;
+
+  const char* args[5] = { "" } ;
+
+  args[1] = "-o" ;
+  args[2] = fname ;
+  BOOST_CHECK_NO_THROW(cmdline.parse(3, args));
+  BOOST_CHECK_EQUAL(optVerbose.value(), 1);
+  BOOST_CHECK_EQUAL(optInt1.value(), 100);
+  BOOST_CHECK_EQUAL(optInt2.value(), 200);
+  BOOST_CHECK_EQUAL(optName.value(), "some string with spaces");
+  BOOST_CHECK_EQUAL(optList.size(), 3U);
+
+  // command line overrides options file
+  args[3] = "-x5" ;
+  BOOST_CHECK_NO_THROW(cmdline.parse(4, args));
+  BOOST_CHECK_EQUAL(optInt1.value(), 5);
+  BOOST_CHECK_EQUAL(optInt2.value(), 200);
+
+  unlink(fname);
+  BOOST_CHECK_THROW(cmdline.parse(3, args), AppCmdException);
+}
+
+// ==============================================================
+
+BOOST_AUTO_TEST_CASE( cmdline_test_optfile_format )
+{
+  char fname[] = "/tmp/AppCmdLineTest-XXXXXX";
+  int fd = mkstemp(fname);
+  BOOST_REQUIRE(fd >= 0);
+  close(fd);
+
+  AppCmdLine cmdline( "command" ) ;
+  AppCmdOptList<std::string> optFile(cmdline, "o,options", "path", "options file");
+  cmdline.setOptionsFile(optFile);
+  AppCmdOpt<int> optInt1(cmdline, "x,number1", "number", "some number", 1 ) ;
+  AppCmdOpt<std::string> optName(cmdline, "name", "string", "some string", "default" ) ;
+
+  const char* args[3] = { "", "-o", fname } ;
+
+  // empty file
+  BOOST_CHECK_NO_THROW(cmdline.parse(3, args));
+  BOOST_CHECK_EQUAL(optInt1.value(), 1);
+  BOOST_CHECK_EQUAL(optName.value(), "default");
+
+  // tabs and last line without newline
+  {
+    std::ofstream out(fname);
+    out << "\t# comment line\n"
+        << "\tnumber1\t=\t100\t\n"
+        << "name =";
+  }
+  BOOST_CHECK_NO_THROW(cmdline.parse(3, args));
+  BOOST_CHECK_EQUAL(optInt1.value(), 100);
+  BOOST_CHECK_EQUAL(optName.value(), "");
+  BOOST_CHECK(optName.valueChanged());
+
+  // unknown option
+  {
+    std::ofstream out(fname);
+    out << "number1 = 100\n"
+        << "number2 = 100\n";
+  }
+  BOOST_CHECK_THROW(cmdline.parse(3, args), AppCmdException);
+
+  unlink(fname);
+}
+
+// ==============================================================
+
+BOOST_AUTO_TEST_CASE( cmdline_test_optfile_cache )
+{
+  char dname[] = "/tmp/AppCmdLineTest-cache-XXXXXX";
+  BOOST_REQUIRE(mkdtemp(dname));
+  const std::string fname = std::string(dname) + "/options.cfg";
+  {
+    std::ofstream out(fname.c_str());
+    out << "# comment line\n"
+        << "number1 = 100\n"
+        << "name = some string with spaces \n";
+  }
+
+  AppCmdLine cmdline( "command" ) ;
+  AppCmdOptList<std::string> optFile(cmdline, "o,options", "path", "options file");
+  cmdline.setOptionsFile(optFile);
+  cmdline.setOptionsFileCache(dname);
+  AppCmdOpt<int> optInt1(cmdline, "x,number1", "number", "some number", 1 ) ;
+  AppCmdOpt<std::string> optName(cmdline, "name", "string", "some string", "" ) ;
+
+  const char* args[3] = { "", "-o", fname.c_str() } ;
+
+  // first parse makes cache
+  BOOST_CHECK(not AppCmdOptFile(fname).fromCache());
+  BOOST_CHECK_NO_THROW(cmdline.parse(3, args));
+  BOOST_CHECK_EQUAL(optInt1.value(), 100);
+  BOOST_CHECK_EQUAL(optName.value(), "some string with spaces");
+
+  // cache is used now
+  {
+    AppCmdOptFile optf(fname, dname);
+    BOOST_CHECK(optf.fromCache());
+    BOOST_REQUIRE_EQUAL(optf.entries().size(), 2U);
+    BOOST_CHECK_EQUAL(optf.entries()[0].name, "number1");
+    BOOST_CHECK_EQUAL(optf.entries()[0].value, "100");
+    BOOST_CHECK_EQUAL(optf.entries()[0].line, 2U);
+    BOOST_CHECK_EQUAL(optf.entries()[1].name, "name");
+    BOOST_CHECK_EQUAL(optf.entries()[1].value, "some string with spaces");
+  }
+  BOOST_CHECK_NO_THROW(cmdline.parse(3, args));
+  BOOST_CHECK_EQUAL(optInt1.value(), 100);
+  BOOST_CHECK_EQUAL(optName.value(), "some string with spaces");
+
+  // same contents with different modification time still uses cache
+  struct timeval times[2] = { { 1000000000, 0 }, { 1000000000, 0 } };
+  BOOST_REQUIRE(utimes(fname.c_str(), times) == 0);
+  BOOST_CHECK(AppCmdOptFile(fname, dname).fromCache());
+
+  // changed file is parsed again
+  {
+    std::ofstream out(fname.c_str());
+    out << "number1 = 200\n";
+  }
+  BOOST_CHECK(not AppCmdOptFile(fname, dname).fromCache());
+  BOOST_CHECK_NO_THROW(cmdline.parse(3, args));
+  BOOST_CHECK_EQUAL(optInt1.value(), 200);
+  BOOST_CHECK_EQUAL(optName.value(), "");
+  BOOST_CHECK(AppCmdOptFile(fname, dname).fromCache());
+
+  // corrupted cache is ignored
+  std::vector<std::string> cacheFiles;
+  DIR* dir = opendir(dname);
+  BOOST_REQUIRE(dir);
+  while (struct dirent* dent = readdir(dir)) {
+    const std::string name = dent->d_name;
+    if (name.size() > 9 and name.compare(name.size() - 9, 9, ".optcache") == 0) {
+      cacheFiles.push_back(std::string(dname) + "/" + name);
+    }
+  }
+  closedir(dir);
+  BOOST_REQUIRE_EQUAL(cacheFiles.size(), 1U);
+  {
+    std::ofstream out(cacheFiles[0].c_str());
+    out << "AppOptC1 garbage";
+  }
+  BOOST_CHECK_NO_THROW(cmdline.parse(3, args));
+  BOOST_CHECK_EQUAL(optInt1.value(), 200);
+  BOOST_CHECK(AppCmdOptFile(fname, dname).fromCache());
+
+  unlink(cacheFiles[0].c_str());
+  unlink(fname.c_str());
+  rmdir(dname);
+}
+
+// ==============================================================
+
+BOOST_AUTO_TEST_CASE( cmdline_test_compile )
+{
+  AppCmdLine cmdline( "command" ) ;
+  AppCmdOptGroup group1(cmdline, "Input options");
+  AppCmdOptIncr optVerbose(cmdline, "v,verbose", "make more noise", 0 );
+  AppCmdOpt<int> optInt1(group1, "x,number1", "number", "some number", 1 ) ;
+  AppCmdArg<std::string> argString(cmdline, "name", "specifies the name", "");
+
+  BOOST_CHECK(not cmdline.compiled());
+  BOOST_CHECK_NO_THROW(cmdline.compile());
+  BOOST_CHECK(cmdline.compiled());
+
+  const char* args[5] = { "" } ;
+
+  // parse many times
+  args[1] = "-vv" ;
+  args[2] = "-x100" ;
+  args[3] = "name" ;
+  for (int i = 0; i != 3; ++ i) {
+    BOOST_CHECK_NO_THROW(cmdline.parse(4, args));
+    BOOST_CHECK_EQUAL(optVerbose.value(), 2);
+    BOOST_CHECK_EQUAL(optInt1.value(), 100);
+    BOOST_CHECK_EQUAL(argString.value(), "name");
+  }
+  BOOST_CHECK_NO_THROW(cmdline.parse(2, args));
+  BOOST_CHECK_EQUAL(optInt1.value(), 1);
+  BOOST_CHECK_EQUAL(argString.value(), "");
+
+  // cannot add anything after compilation
+  AppCmdOpt<int> optInt2("y,number2", "number", "some number", 2 ) ;
+  BOOST_CHECK_THROW(cmdline.addOption(optInt2), AppCmdException);
+  AppCmdOptGroup group2("Output options");
+  BOOST_CHECK_THROW(cmdline.addGroup(group2), AppCmdException);
+  AppCmdArg<std::string> argString2("name2", "specifies the name", "");
+  BOOST_CHECK_THROW(cmdline.addArgument(argString2), AppCmdException);
+
+  // options added to the group are detected by parse
+  group1.addOption(optInt2);
+  BOOST_CHECK_THROW(cmdline.parse(2, args), AppCmdException);
+}
+
+// ==============================================================
+
+BOOST_AUTO_TEST_CASE( cmdline_test_compile_errors )
+{
+  AppCmdLine cmdline( "command" ) ;
+  AppCmdOpt<int> optInt1(cmdline, "x,number", "number", "some number", 1 ) ;
+  AppCmdOpt<int> optInt2(cmdline, "y,number", "number", "some number", 2 ) ;
+
+  BOOST_CHECK_THROW(cmdline.compile(), AppCmdOptDefinedException);
+  BOOST_CHECK(not cmdline.compiled());
+}
+
+// ==============================================================
+
+BOOST_AUTO_TEST_CASE( cmdline_test_words )
+{
+  AppCmdLine cmdline( "command" ) ;
+  AppCmdOptIncr optVerbose(cmdline, "v,verbose", "make more noise", 0 ) ;
+  AppCmdOpt<std::string> optName(cmdline, "n,name", "string", "some name", "" ) ;
+  AppCmdArgList<std::string> argStringL(cmdline, "names", "specifies the name(s)", AppCmdArgList<std::string>::container()) ;
+
+  {
+    // words must stay valid after source strings are gone
+    std::vector<std::string> args ;
+    args.push_back ( "-vv" ) ;
+    args.push_back ( "-nfirst name" ) ;
+    args.push_back ( "--verbose" ) ;
+    args.push_back ( "--" ) ;
+    args.push_back ( "-v" ) ;
+    args.push_back ( "" ) ;
+    BOOST_CHECK_NO_THROW ( cmdline.parse ( args.begin(), args.end() ) ) ;
+  }
+  BOOST_CHECK_EQUAL( cmdline.cmdline(), "command -vv '-nfirst name' --verbose -- -v " ) ;
+  BOOST_CHECK_EQUAL( optVerbose.value(), 3 ) ;
+  BOOST_CHECK_EQUAL( optName.value(), "first name" ) ;
+  BOOST_CHECK_EQUAL( argStringL.size(), 2U ) ;
+  BOOST_CHECK_EQUAL( *argStringL.begin(), "-v" ) ;
+
+  // missing option argument
+  const char* args[3] = { "", "-v", "--name" } ;
+  BOOST_CHECK_THROW( cmdline.parse ( 3, args ), AppCmdException ) ;
+  args[2] = "-n" ;
+  BOOST_CHECK_THROW( cmdline.parse ( 3, args ), AppCmdException ) ;
+  args[2] = "--name=" ;
+  BOOST_CHECK_NO_THROW( cmdline.parse ( 3, args ) ) ;
+  BOOST_CHECK_EQUAL( optName.value(), "" ) ;
+  BOOST_CHECK( optName.valueChanged() ) ;
+
+  // NUL byte inside a word does not split it
+  {
+    std::vector<std::string> args ;
+    args.push_back ( std::string("--name=a\0b", 10) ) ;
+    args.push_back ( std::string("x\0y", 3) ) ;
+    BOOST_CHECK_NO_THROW ( cmdline.parse ( args.begin(), args.end() ) ) ;
+  }
+  BOOST_CHECK_EQUAL( optName.value(), std::string("a\0b", 3) ) ;
+  BOOST_CHECK_EQUAL( argStringL.size(), 1U ) ;
+  BOOST_CHECK_EQUAL( *argStringL.begin(), std::string("x\0y", 3) ) ;
+}
+
+// ==============================================================
+
+BOOST_AUTO_TEST_CASE( cmdline_test_batch )
+{
+  char fname[] = "/tmp/AppCmdLineTest-XXXXXX";
+  int fd = mkstemp(fname);
+  BOOST_REQUIRE(fd >= 0);
+  close(fd);
+  {
+    std::ofstream out(fname);
+    out << "number = 100\n"
+        << "size = 1k\n";
+  }
+
+  AppCmdLine cmdline( "command" ) ;
+  AppCmdOptList<std::string> optFile(cmdline, "o,options", "path", "options file");
+  cmdline.setOptionsFile(optFile);
+  AppCmdOptIncr optVerbose(cmdline, "v,verbose", "make more noise", 0 );
+  AppCmdOptToggle optToggle(cmdline, "t,toggle", "toggle something", false );
+  AppCmdOptBool optBool(cmdline, "b,bool", "set something", false );
+  AppCmdOpt<int> optInt(cmdline, "n,number", "number", "some number", 1 ) ;
+  AppCmdOptSize optSize(cmdline, "s,size", "size", "some size", 1 ) ;
+  AppCmdOptNamedValue<int> optNamed(cmdline, "m,mode", "mode", "some mode", 0 ) ;
+  optNamed.add("one", 1);
+  AppCmdOptList<int> optList(cmdline, "l,list", "number", "list of numbers" ) ;
+  AppCmdArg<std::string> argString(cmdline, "name", "specifies the name");
+  AppCmdArgList<int> argList(cmdline, "numbers", "list of numbers", AppCmdArgList<int>::container());
+
+  std::vector<std::vector<std::string> > cmdlines;
+  for (int i = 0; i != 100; ++ i) {
+    std::vector<std::string> args;
+    switch (i % 5) {
+    case 0:
+      // all options
+      args.push_back("-vvtb");
+      args.push_back("--number=5");
+      args.push_back("-s2M");
+      args.push_back("--mode=one");
+      args.push_back("-l1,2,3");
+      args.push_back("name");
+      args.push_back("1");
+      args.push_back("2");
+      break;
+    case 1:
+      // options file
+      args.push_back("-o");
+      args.push_back(fname);
+      args.push_back("name");
+      break;
+    case 2:
+      // conversion error
+      args.push_back("--number=x");
+      args.push_back("name");
+      break;
+    case 3:
+      // help
+      args.push_back("-v");
+      args.push_back("--help");
+      break;
+    case 4:
+      // missing argument
+      args.push_back("-v");
+      break;
+    }
+    cmdlines.push_back(args);
+  }
+
+  AppCmdLine::BatchResults results = cmdline.parseBatch(cmdlines, 4);
+  BOOST_CHECK(cmdline.compiled());
+  BOOST_REQUIRE_EQUAL(results.size(), cmdlines.size());
+  for (unsigned i = 0; i != results.size(); ++ i) {
+    switch (i % 5) {
+    case 0:
+    case 1:
+      BOOST_CHECK(results[i].ok);
+      BOOST_CHECK(not results[i].helpWanted);
+      BOOST_CHECK_EQUAL(results[i].error, "");
+      break;
+    case 2:
+    case 4:
+      BOOST_CHECK(not results[i].ok);
+      BOOST_CHECK(not results[i].error.empty());
+      break;
+    case 3:
+      BOOST_CHECK(results[i].ok);
+      BOOST_CHECK(results[i].helpWanted);
+      break;
+    }
+  }
+
+  // options were not touched
+  BOOST_CHECK_EQUAL(optVerbose.value(), 0);
+  BOOST_CHECK(not optVerbose.valueChanged());
+  BOOST_CHECK_EQUAL(optInt.value(), 1);
+  BOOST_CHECK(optList.empty());
+
+  // same parser can be used in regular way
+  const char* args[4] = { "", "-o", fname, "name" } ;
+  BOOST_CHECK_NO_THROW(cmdline.parse(4, args));
+  BOOST_CHECK_EQUAL(optInt.value(), 100);
+  BOOST_CHECK_EQUAL(optSize.value(), 1024U);
+  BOOST_CHECK_EQUAL(argString.value(), "name");
+
+  unlink(fname);
+}
+
+namespace {
+// parse the same command line many times into separate result
+void parseMany(const AppCmdLine* cmdline, const std::vector<std::string>* args, const AppCmdOptIncr* optVerbose,
+    const AppCmdOptList<int>* optList, const AppCmdArg<std::string>* argString, int* nGood)
+{
+  AppCmdParseResult result;
+  for (int i = 0; i != 1000; ++ i) {
+    cmdline->parse(args->begin(), args->end(), result);
+    if (result.value(*optVerbose) == 3 and result.value(*optList).size() == 3
+        and result.value(*argString) == "name") ++ *nGood;
+  }
+}
+}
+
+// ==============================================================
+
+BOOST_AUTO_TEST_CASE( cmdline_test_result )
+{
+  AppCmdLine cmdline( "command" ) ;
+  AppCmdOptIncr optVerbose(cmdline, "v,verbose", "make more noise", 0 );
+  AppCmdOptToggle optToggle(cmdline, "t,toggle", "toggle something", false );
+  AppCmdOptBool optBool(cmdline, "b,bool", "set something", false );
+  AppCmdOpt<int> optInt(cmdline, "n,number", "number", "some number", 1 ) ;
+  AppCmdOptSize optSize(cmdline, "s,size", "size", "some size", 1 ) ;
+  AppCmdOptNamedValue<int> optNamed(cmdline, "m,mode", "mode", "some mode", 0 ) ;
+  optNamed.add("one", 1);
+  AppCmdOptList<int> optList(cmdline, "l,list", "number", "list of numbers" ) ;
+  AppCmdArg<std::string> argString(cmdline, "name", "specifies the name");
+  AppCmdArgList<int> argList(cmdline, "numbers", "list of numbers", AppCmdArgList<int>::container());
+  AppCmdOptIncr optOther("x", "not in parser", 0 );
+  AppCmdOptIncr optSameName("v,verbose", "not in parser, same name as known option", 0 );
+
+  AppCmdParseResult result;
+  const char* args[] = { "", "-vvtb", "--number=5", "-s2M", "--mode=one", "-l1,2,3", "name", "1", "2" } ;
+
+  // parser must be compiled
+  BOOST_CHECK_THROW(cmdline.parse(9, args, result), AppCmdException);
+  cmdline.compile();
+
+  // result is empty before parsing
+  BOOST_CHECK_THROW(result.value(optVerbose), AppCmdException);
+
+  BOOST_CHECK_NO_THROW(cmdline.parse(9, args, result));
+  BOOST_CHECK(not result.helpWanted());
+  BOOST_CHECK_EQUAL(result.value(optVerbose), 2);
+  BOOST_CHECK(result.valueChanged(optVerbose));
+  BOOST_CHECK_EQUAL(result.value(optToggle), true);
+  BOOST_CHECK_EQUAL(result.value(optBool), true);
+  BOOST_CHECK_EQUAL(result.value(optInt), 5);
+  BOOST_CHECK_EQUAL(result.value(optSize), 2*1024*1024U);
+  BOOST_CHECK_EQUAL(result.value(optNamed), 1);
+  BOOST_CHECK_EQUAL(result.value(optList).size(), 3U);
+  BOOST_CHECK_EQUAL(result.value(argString), "name");
+  BOOST_CHECK_EQUAL(result.value(argList).size(), 2U);
+  BOOST_CHECK_THROW(result.value(optOther), AppCmdException);
+  BOOST_CHECK_THROW(result.valueChanged(optOther), AppCmdException);
+  BOOST_CHECK_THROW(result.value(optSameName), AppCmdException);
+
+  // options were not touched
+  BOOST_CHECK_EQUAL(optVerbose.value(), 0);
+  BOOST_CHECK_EQUAL(optInt.value(), 1);
+  BOOST_CHECK(optList.empty());
+  BOOST_CHECK(argList.empty());
+
+  // result is reset on next parse
+  std::vector<std::string> words;
+  words.push_back("--help");
+  BOOST_CHECK_NO_THROW(cmdline.parse(words.begin(), words.end(), result));
+  BOOST_CHECK(result.helpWanted());
+  BOOST_CHECK_EQUAL(result.value(optVerbose), 0);
+  BOOST_CHECK(not result.valueChanged(optVerbose));
+
+  words.clear();
+  words.push_back("-n");
+  BOOST_CHECK_THROW(cmdline.parse(words.begin(), words.end(), result), AppCmdException);
+
+  // many threads share one parser
+  words.clear();
+  words.push_back("-vvv");
+  words.push_back("-l1,2,3");
+  words.push_back("name");
+  int nGood[4] = { 0, 0, 0, 0 };
+  boost::thread_group threads;
+  for (int i = 0; i != 4; ++ i) {
+    threads.create_thread(boost::bind(parseMany, &cmdline, &words, &optVerbose, &optList, &argString, &nGood[i]));
+  }
+  threads.join_all();
+  for (int i = 0; i != 4; ++ i) {
+    BOOST_CHECK_EQUAL(nGood[i], 1000);
+  }
+}
+
+// ==============================================================
+
+BOOST_AUTO_TEST_CASE( cmdline_test_type_traits )
+{
+  // integers
+  BOOST_CHECK_EQUAL(AppCmdTypeTraits<int>::fromString("123"), 123);
+  BOOST_CHECK_EQUAL(AppCmdTypeTraits<int>::fromString("-123"), -123);
+  BOOST_CHECK_EQUAL(AppCmdTypeTraits<int>::fromString("+12"), 12);
+  BOOST_CHECK_EQUAL(AppCmdTypeTraits<int>::fromString(" 12"), 12);
+  BOOST_CHECK_EQUAL(AppCmdTypeTraits<int>::fromString("0x1F"), 31);
+  BOOST_CHECK_EQUAL(AppCmdTypeTraits<int>::fromString("010"), 8);
+  BOOST_CHECK_EQUAL(AppCmdTypeTraits<int>::fromString("0"), 0);
+  BOOST_CHECK_EQUAL(AppCmdTypeTraits<int>::fromString("-0"), 0);
+  BOOST_CHECK_EQUAL(AppCmdTypeTraits<int>::fromString("2147483647"), 2147483647);
+  BOOST_CHECK_EQUAL(AppCmdTypeTraits<int>::fromString("-2147483648"), -2147483647-1);
+  BOOST_CHECK_THROW(AppCmdTypeTraits<int>::fromString("2147483648"), AppCmdTypeCvtException);
+  BOOST_CHECK_THROW(AppCmdTypeTraits<int>::fromString("-2147483649"), AppCmdTypeCvtException);
+  BOOST_CHECK_THROW(AppCmdTypeTraits<int>::fromString(""), AppCmdTypeCvtException);
+  BOOST_CHECK_THROW(AppCmdTypeTraits<int>::fromString("-"), AppCmdTypeCvtException);
+  BOOST_CHECK_THROW(AppCmdTypeTraits<int>::fromString("0x"), AppCmdTypeCvtException);
+  BOOST_CHECK_THROW(AppCmdTypeTraits<int>::fromString("08"), AppCmdTypeCvtException);
+  BOOST_CHECK_THROW(AppCmdTypeTraits<int>::fromString("12 "), AppCmdTypeCvtException);
+  BOOST_CHECK_THROW(AppCmdTypeTraits<int>::fromString("1.5"), AppCmdTypeCvtException);
+  BOOST_CHECK_EQUAL(AppCmdTypeTraits<short>::fromString("-32768"), -32768);
+  BOOST_CHECK_THROW(AppCmdTypeTraits<short>::fromString("32768"), AppCmdTypeCvtException);
+  BOOST_CHECK_EQUAL(AppCmdTypeTraits<unsigned short>::fromString("65535"), 65535);
+  BOOST_CHECK_THROW(AppCmdTypeTraits<unsigned short>::fromString("65536"), AppCmdTypeCvtException);
+  BOOST_CHECK_THROW(AppCmdTypeTraits<unsigned int>::fromString("-1"), AppCmdTypeCvtException);
+  BOOST_CHECK_EQUAL(AppCmdTypeTraits<unsigned long>::fromString("-1"), std::strtoul("-1", 0, 0));
+  BOOST_CHECK_EQUAL(AppCmdTypeTraits<long long>::fromString("-9223372036854775808"), -9223372036854775807LL-1);
+  BOOST_CHECK_THROW(AppCmdTypeTraits<long long>::fromString("9223372036854775808"), AppCmdTypeCvtException);
+  BOOST_CHECK_EQUAL(AppCmdTypeTraits<unsigned long long>::fromString("18446744073709551615"), 18446744073709551615ULL);
+  BOOST_CHECK_EQUAL(AppCmdTypeTraits<unsigned long long>::fromString("0xffffffffffffffff"), 18446744073709551615ULL);
+  BOOST_CHECK_THROW(AppCmdTypeTraits<unsigned long long>::fromString("18446744073709551616"), AppCmdTypeCvtException);
+
+  // characters
+  BOOST_CHECK_EQUAL(AppCmdTypeTraits<char>::fromString("x"), 'x');
+  BOOST_CHECK_THROW(AppCmdTypeTraits<char>::fromString(""), AppCmdTypeCvtException);
+  BOOST_CHECK_THROW(AppCmdTypeTraits<char>::fromString("xy"), AppCmdTypeCvtException);
+
+  // floating point
+  BOOST_CHECK_EQUAL(AppCmdTypeTraits<double>::fromString("1.5"), 1.5);
+  BOOST_CHECK_EQUAL(AppCmdTypeTraits<double>::fromString("-.5e1"), -5.);
+  BOOST_CHECK_EQUAL(AppCmdTypeTraits<double>::fromString("5."), 5.);
+  BOOST_CHECK_EQUAL(AppCmdTypeTraits<double>::fromString("0x1p3"), 8.);
+  BOOST_CHECK_EQUAL(AppCmdTypeTraits<double>::fromString("1e-320"), std::strtod("1e-320", 0));
+  BOOST_CHECK_EQUAL(AppCmdTypeTraits<double>::fromString("-inf"), -std::numeric_limits<double>::infinity());
+  BOOST_CHECK(AppCmdTypeTraits<double>::fromString("NaN") != AppCmdTypeTraits<double>::fromString("NaN"));
+  BOOST_CHECK_THROW(AppCmdTypeTraits<double>::fromString("1e400"), AppCmdTypeCvtException);
+  BOOST_CHECK_THROW(AppCmdTypeTraits<double>::fromString("1e-400"), AppCmdTypeCvtException);
+  BOOST_CHECK_THROW(AppCmdTypeTraits<double>::fromString("."), AppCmdTypeCvtException);
+  BOOST_CHECK_THROW(AppCmdTypeTraits<double>::fromString("1e"), AppCmdTypeCvtException);
+  BOOST_CHECK_THROW(AppCmdTypeTraits<double>::fromString("1.5x"), AppCmdTypeCvtException);
+  BOOST_CHECK_THROW(AppCmdTypeTraits<float>::fromString("1e39"), AppCmdTypeCvtException);
+
+  // results must be identical to C library for many random numbers
+  std::srand(42);
+  char buf[64];
+  for (int i = 0; i != 100000; ++ i) {
+    const int mantDigits = 1 + std::rand() % 20;
+    int pos = 0;
+    if (std::rand() % 2) buf[pos ++] = '-';
+    const int dotPos = std::rand() % (mantDigits + 1);
+    for (int d = 0; d != mantDigits; ++ d) {
+      if (d == dotPos) buf[pos ++] = '.';
+      buf[pos ++] = '0' + std::rand() % 10;
+    }
+    if (std::rand() % 2) pos += std::sprintf(buf + pos, "e%d", std::rand() % 80 - 40);
+    buf[pos] = '\0';
+    const double dval = AppCmdTypeTraits<double>::fromString(buf);
+    const double dexp = std::strtod(buf, 0);
+    BOOST_CHECK_MESSAGE(std::memcmp(&dval, &dexp, sizeof dval) == 0, buf);
+    errno = 0;
+    const float fexp = std::strtof(buf, 0);
+    if (errno == 0) {
+      const float fval = AppCmdTypeTraits<float>::fromString(buf);
+      BOOST_CHECK_MESSAGE(std::memcmp(&fval, &fexp, sizeof fval) == 0, buf);
+    }
+  }
+
+  // hexadecimal floating point numbers, including long mantissas and subnormals
+  BOOST_CHECK_EQUAL(AppCmdTypeTraits<double>::fromString("-0x1.8"), -1.5);
+  BOOST_CHECK_EQUAL(AppCmdTypeTraits<double>::fromString("0x.8p1"), 1.);
+  BOOST_CHECK_EQUAL(AppCmdTypeTraits<double>::fromString("0x0p100"), 0.);
+  BOOST_CHECK_THROW(AppCmdTypeTraits<double>::fromString("0x1p1024"), AppCmdTypeCvtException);
+  BOOST_CHECK_THROW(AppCmdTypeTraits<double>::fromString("0x1p-1080"), AppCmdTypeCvtException);
+  BOOST_CHECK_THROW(AppCmdTypeTraits<double>::fromString("0x1p"), AppCmdTypeCvtException);
+  BOOST_CHECK_THROW(AppCmdTypeTraits<double>::fromString("0x.p1"), AppCmdTypeCvtException);
+  for (int i = 0; i != 100000; ++ i) {
+    const int mantDigits = 1 + std::rand() % 20;
+    int pos = std::sprintf(buf, "%s0x", std::rand() % 2 ? "-" : "");
+    const int dotPos = std::rand() % (mantDigits + 1);
+    for (int d = 0; d != mantDigits; ++ d) {
+      if (d == dotPos) buf[pos ++] = '.';
+      buf[pos ++] = "0123456789abcdef"[std::rand() % 16];
+    }
+    if (std::rand() % 4) pos += std::sprintf(buf + pos, "p%d", std::rand() % 2300 - 1150);
+    buf[pos] = '\0';
+    errno = 0;
+    const double dexp = std::strtod(buf, 0);
+    if (errno == 0 or (dexp != 0 and std::fabs(dexp) <= std::numeric_limits<double>::max())) {
+      const double dval = AppCmdTypeTraits<double>::fromString(buf);
+      BOOST_CHECK_MESSAGE(std::memcmp(&dval, &dexp, sizeof dval) == 0, buf);
+    }
+    errno = 0;
+    const float fexp = std::strtof(buf, 0);
+    if (errno == 0 or (fexp != 0 and std::fabs(fexp) <= std::numeric_limits<float>::max())) {
+      const float fval = AppCmdTypeTraits<float>::fromString(buf);
+      BOOST_CHECK_MESSAGE(std::memcmp(&fval, &fexp, sizeof fval) == 0, buf);
+    }
+  }
+}
+
+// ==============================================================
+
+BOOST_AUTO_TEST_CASE( cmdline_test_optlist_bulk )
+{
+  AppCmdLine cmdline( "command" ) ;
+  AppCmdOptList<int> optInt(cmdline, "i,int", "number", "list of numbers" ) ;
+  AppCmdOptList<double> optDouble(cmdline, "d,double", "number", "list of numbers", ':' ) ;
+  AppCmdOptList<unsigned long long> optULL(cmdline, "u,ull", "number", "list of numbers" ) ;
+
+  // long list
+  std::string list;
+  for (int i = 0; i != 100000; ++ i) {
+    if (i) list += ',';
+    list += AppCmdTypeTraits<int>::toString(i - 50000);
+  }
+  const char* args1[] = { "", "-i", list.c_str(), "-i", "1,2,", "-d", "1.5:-2e3:0x10", "-u", "0xffffffffffffffff" } ;
+  BOOST_CHECK_NO_THROW(cmdline.parse(9, args1));
+  BOOST_CHECK_EQUAL(optInt.size(), 100002U);
+  BOOST_CHECK_EQUAL(optInt.value()[0], -50000);
+  BOOST_CHECK_EQUAL(optInt.value()[99999], 49999);
+  BOOST_CHECK_EQUAL(optInt.value()[100000], 1);
+  BOOST_CHECK_EQUAL(optInt.value()[100001], 2);
+  BOOST_CHECK_EQUAL(optDouble.size(), 3U);
+  BOOST_CHECK_EQUAL(optDouble.value()[0], 1.5);
+  BOOST_CHECK_EQUAL(optDouble.value()[1], -2000.);
+  BOOST_CHECK_EQUAL(optDouble.value()[2], 16.);
+  BOOST_CHECK_EQUAL(optULL.size(), 1U);
+  BOOST_CHECK_EQUAL(optULL.value()[0], 18446744073709551615ULL);
+
+  // conversion errors, message contains bad item
+  const char* args2[] = { "", "-i", "1,2,x3,4" } ;
+  try {
+    cmdline.parse(3, args2);
+    BOOST_ERROR("exception expected");
+  } catch (const AppCmdTypeCvtException& exc) {
+    BOOST_CHECK(std::string(exc.what()).find("\"x3\"") != std::string::npos);
+  }
+  const char* args3[] = { "", "-i", "1,,2" } ;
+  BOOST_CHECK_THROW(cmdline.parse(3, args3), AppCmdTypeCvtException);
+  const char* args4[] = { "", "-i", "" } ;
+  BOOST_CHECK_THROW(cmdline.parse(3, args4), AppCmdTypeCvtException);
+  const char* args5[] = { "", "-i", "3000000000" } ;
+  BOOST_CHECK_THROW(cmdline.parse(3, args5), AppCmdTypeCvtException);
+
+  // bulk conversion into parse result
+  cmdline.compile();
+  AppCmdParseResult result;
+  const char* args6[] = { "", "-i", "1,2", "-i", "3,x" } ;
+  BOOST_CHECK_THROW(cmdline.parse(5, args6, result), AppCmdTypeCvtException);
+  const char* args7[] = { "", "-i", "1,2", "-i", "3,4" } ;
+  BOOST_CHECK_NO_THROW(cmdline.parse(5, args7, result));
+  BOOST_CHECK_EQUAL(result.value(optInt).size(), 4U);
+}
+
+// ==============================================================
+
+BOOST_AUTO_TEST_CASE( cmdline_test_optrangelist )
+{
+  AppCmdLine cmdline( "command" ) ;
+  AppCmdOptRangeList<int> optRuns(cmdline, "r,runs", "runs", "list of runs" ) ;
+  AppCmdOptRangeList<unsigned long long> optEvents(cmdline, "e,events", "events", "list of events" ) ;
+
+  const char* args1[] = { "", "-r", "1-100,200-300:5,1000", "-r", "-10--5", "-e", "0-1000000000000", "-e", "7" } ;
+  BOOST_CHECK_NO_THROW(cmdline.parse(9, args1));
+  BOOST_CHECK(optRuns.valueChanged());
+  BOOST_CHECK_EQUAL(optRuns.value().size(), 4U);
+  BOOST_CHECK_EQUAL(optRuns.value().count(), 100U + 21U + 1U + 6U);
+  BOOST_CHECK(optRuns.contains(1));
+  BOOST_CHECK(optRuns.contains(50));
+  BOOST_CHECK(optRuns.contains(100));
+  BOOST_CHECK(not optRuns.contains(101));
+  BOOST_CHECK(optRuns.contains(200));
+  BOOST_CHECK(optRuns.contains(205));
+  BOOST_CHECK(not optRuns.contains(206));
+  BOOST_CHECK(optRuns.contains(300));
+  BOOST_CHECK(optRuns.contains(1000));
+  BOOST_CHECK(not optRuns.contains(999));
+  BOOST_CHECK(optRuns.contains(-10));
+  BOOST_CHECK(optRuns.contains(-5));
+  BOOST_CHECK(not optRuns.contains(-4));
+  BOOST_CHECK(not optRuns.contains(0));
+
+  // ranges are sorted
+  AppCmdRangeList<int>::const_iterator it = optRuns.value().begin();
+  BOOST_CHECK_EQUAL(it->first, -10);
+  BOOST_CHECK_EQUAL(it->last, -5);
+  ++ it;
+  BOOST_CHECK_EQUAL(it->first, 1);
+  BOOST_CHECK_EQUAL(it->last, 100);
+  ++ it;
+  BOOST_CHECK_EQUAL(it->first, 200);
+  BOOST_CHECK_EQUAL(it->last, 300);
+  BOOST_CHECK_EQUAL(it->stride, 5);
+
+  // ranges are not expanded
+  BOOST_CHECK_EQUAL(optEvents.value().size(), 2U);
+  BOOST_CHECK_EQUAL(optEvents.value().count(), 1000000000002ULL);
+  BOOST_CHECK(optEvents.contains(999999999999ULL));
+  BOOST_CHECK(not optEvents.contains(1000000000001ULL));
+
+  // count of the full 64-bit range does not fit and is saturated
+  AppCmdRangeList<unsigned long long> full;
+  full.add("0-18446744073709551615");
+  BOOST_CHECK_EQUAL(full.count(), std::numeric_limits<unsigned long long>::max());
+  full.clear();
+  full.add("1-18446744073709551615");
+  BOOST_CHECK_EQUAL(full.count(), std::numeric_limits<unsigned long long>::max());
+  full.add("0");
+  BOOST_CHECK_EQUAL(full.count(), std::numeric_limits<unsigned long long>::max());
+  full.clear();
+  full.add("0-18446744073709551615:2");
+  BOOST_CHECK_EQUAL(full.count(), 9223372036854775808ULL);
+
+  // last value is adjusted to stride
+  AppCmdRangeList<int> ranges;
+  ranges.add("10-20:3");
+  BOOST_CHECK_EQUAL(ranges.begin()->last, 19);
+  BOOST_CHECK(ranges.contains(19));
+  BOOST_CHECK(not ranges.contains(20));
+
+  // overlapping ranges
+  ranges.add("0-100:2,5-1000:10,17");
+  BOOST_CHECK(ranges.contains(10));
+  BOOST_CHECK(ranges.contains(16));
+  BOOST_CHECK(ranges.contains(17));
+  BOOST_CHECK(ranges.contains(995));
+  BOOST_CHECK(not ranges.contains(101));
+  BOOST_CHECK(not ranges.contains(21));
+
+  // errors leave set unchanged
+  const AppCmdRangeList<int>::size_type size = ranges.size();
+  BOOST_CHECK_THROW(ranges.add("1-2,x"), AppCmdTypeCvtException);
+  BOOST_CHECK_THROW(ranges.add("5-1"), AppCmdTypeCvtException);
+  BOOST_CHECK_THROW(ranges.add("1-5:0"), AppCmdTypeCvtException);
+  BOOST_CHECK_THROW(ranges.add("5:2"), AppCmdTypeCvtException);
+  BOOST_CHECK_THROW(ranges.add("1-"), AppCmdTypeCvtException);
+  BOOST_CHECK_THROW(ranges.add(""), AppCmdTypeCvtException);
+  BOOST_CHECK_THROW(ranges.add(5, 1), AppCmdException);
+  BOOST_CHECK_EQUAL(ranges.size(), size);
+
+  const char* args2[] = { "", "-e", "-1" } ;
+  BOOST_CHECK_THROW(cmdline.parse(3, args2), AppCmdTypeCvtException);
+
+  // parse result
+  cmdline.compile();
+  AppCmdParseResult result;
+  BOOST_CHECK_NO_THROW(cmdline.parse(9, args1, result));
+  BOOST_CHECK_EQUAL(result.value(optRuns).size(), 4U);
+  BOOST_CHECK(result.value(optRuns).contains(250));
+}
+
+// ==============================================================
+
+BOOST_AUTO_TEST_CASE( cmdline_test_lazy )
+{
+  AppCmdLine cmdline( "command" ) ;
+  AppCmdOpt<int> optInt(cmdline, "n,number", "number", "some number", 1 ) ;
+  AppCmdOptList<double> optList(cmdline, "l,list", "number", "list of numbers" ) ;
+  AppCmdOpt<int> optEager(cmdline, "e,eager", "number", "some number", 1 ) ;
+  optInt.setLazy();
+  optList.setLazy();
+  BOOST_CHECK(optInt.lazy());
+  BOOST_CHECK(optList.lazy());
+  BOOST_CHECK(not optEager.lazy());
+
+  // good values
+  const char* args1[] = { "", "-n", "10", "-l", "1,2", "-l", "3.5" } ;
+  BOOST_CHECK_NO_THROW(cmdline.parse(7, args1));
+  BOOST_CHECK(optInt.valueChanged());
+  BOOST_CHECK_EQUAL(optInt.value(), 10);
+  BOOST_CHECK_EQUAL(optList.size(), 3U);
+  BOOST_CHECK_EQUAL(optList.value()[2], 3.5);
+  BOOST_CHECK_NO_THROW(cmdline.validate());
+
+  // errors are reported by value() and validate(), not by parse()
+  const char* args2[] = { "", "-n", "x", "-l", "1,2", "-l", "y" } ;
+  BOOST_CHECK_NO_THROW(cmdline.parse(7, args2));
+  BOOST_CHECK(optInt.valueChanged());
+  BOOST_CHECK_THROW(optInt.value(), AppCmdTypeCvtException);
+  BOOST_CHECK_THROW(optInt.value(), AppCmdTypeCvtException);
+  BOOST_CHECK_THROW(cmdline.validate(), AppCmdTypeCvtException);
+  BOOST_CHECK_THROW(optList.value(), AppCmdTypeCvtException);
+  BOOST_CHECK_THROW(optList.size(), AppCmdTypeCvtException);
+
+  // eager options still report errors from parse()
+  const char* args3[] = { "", "-e", "x" } ;
+  BOOST_CHECK_THROW(cmdline.parse(3, args3), AppCmdTypeCvtException);
+
+  // reset clears unconverted values
+  const char* args4[] = { "" } ;
+  BOOST_CHECK_NO_THROW(cmdline.parse(1, args4));
+  BOOST_CHECK_NO_THROW(cmdline.validate());
+  BOOST_CHECK_EQUAL(optInt.value(), 1);
+  BOOST_CHECK(optList.empty());
+
+  // lazy mode does not apply to parse result
+  cmdline.compile();
+  AppCmdParseResult result;
+  BOOST_CHECK_THROW(cmdline.parse(7, args2, result), AppCmdTypeCvtException);
+  BOOST_CHECK_NO_THROW(cmdline.parse(7, args1, result));
+  BOOST_CHECK_EQUAL(result.value(optInt), 10);
+  BOOST_CHECK_EQUAL(result.value(optList).size(), 3U);
+}
+
+// ==============================================================
+
+BOOST_AUTO_TEST_CASE( cmdline_test_stats )
+{
+  char fname[] = "/tmp/AppCmdLineTest-XXXXXX";
+  int fd = mkstemp(fname);
+  BOOST_REQUIRE(fd >= 0);
+  close(fd);
+  {
+    std::ofstream out(fname);
+    out << "number = 100\n"
+        << "list = a,b\n";
+  }
+
+  AppCmdLine cmdline( "command" ) ;
+  AppCmdOptList<std::string> optFile(cmdline, "o,options", "path", "options file");
+  cmdline.setOptionsFile(optFile);
+  AppCmdOpt<int> optInt(cmdline, "n,number", "number", "some number", 1 ) ;
+  AppCmdOptList<std::string> optList(cmdline, "l,list", "string", "list of strings" ) ;
+  AppCmdArgList<std::string> argList("args", "arguments", AppCmdArgList<std::string>::container()) ;
+  cmdline.addArgument(argList) ;
+
+  AppCmdParseStats stats;
+  cmdline.setParseStats(&stats);
+  BOOST_CHECK(cmdline.parseStats() == &stats);
+
+  const char* args1[] = { "", "-o", fname, "-l", "x", "arg1", "arg2" } ;
+  BOOST_CHECK_NO_THROW(cmdline.parse(7, args1));
+  BOOST_CHECK_EQUAL(optInt.value(), 100);
+
+  BOOST_CHECK_EQUAL(stats.total().count, 1U);
+  BOOST_CHECK_EQUAL(stats.total().items, 6U);
+  BOOST_CHECK_EQUAL(stats.failures(), 0U);
+  BOOST_CHECK_EQUAL(stats.phase(AppCmdParseStats::Split).items, 6U);
+  BOOST_CHECK_EQUAL(stats.phase(AppCmdParseStats::Options).items, 4U);
+  BOOST_CHECK_EQUAL(stats.phase(AppCmdParseStats::Args).items, 2U);
+  BOOST_CHECK_EQUAL(stats.phase(AppCmdParseStats::OptionsFile).count, 1U);
+  BOOST_CHECK(stats.total().time >= stats.phase(AppCmdParseStats::Options).time);
+  BOOST_CHECK_EQUAL(stats.files().size(), 1U);
+  BOOST_CHECK_EQUAL(stats.files().begin()->first, fname);
+  BOOST_CHECK_EQUAL(stats.files().begin()->second.items, 2U);
+  BOOST_CHECK_EQUAL(stats.options().size(), 3U);
+  // options file does not override "list" given on command line
+  BOOST_CHECK_EQUAL(stats.options().find("list")->second.count, 1U);
+  BOOST_CHECK_EQUAL(stats.options().find("number")->second.count, 1U);
+  BOOST_CHECK_EQUAL(stats.options().find("number")->second.items, 3U);
+  // "-o" value, "-l" value, one options file value, two arguments
+  BOOST_CHECK_EQUAL(stats.strings(), 5U);
+
+  // failures are counted too
+  const char* args2[] = { "", "-n", "x" } ;
+  BOOST_CHECK_THROW(cmdline.parse(3, args2), AppCmdException);
+  BOOST_CHECK_EQUAL(stats.total().count, 2U);
+  BOOST_CHECK_EQUAL(stats.failures(), 1U);
+  BOOST_CHECK_EQUAL(stats.options().find("number")->second.count, 2U);
+
+  // const parse methods and batch parsing use the same statistics
+  cmdline.compile();
+  AppCmdParseResult result;
+  BOOST_CHECK_NO_THROW(cmdline.parse(7, args1, result));
+  std::vector<std::vector<std::string> > cmdlines(10, std::vector<std::string>(args1 + 1, args1 + 7));
+  cmdline.parseBatch(cmdlines, 4);
+  BOOST_CHECK_EQUAL(stats.total().count, 13U);
+  BOOST_CHECK_EQUAL(stats.files().begin()->second.count, 12U);
+
+  std::ostringstream str;
+  stats.dump(str);
+  BOOST_CHECK(str.str().find("\"optionsFile\": {\"count\": 12,") != std::string::npos);
+
+  // disabled statistics is not updated
+  cmdline.setParseStats(0);
+  BOOST_CHECK_NO_THROW(cmdline.parse(7, args1));
+  BOOST_CHECK_EQUAL(stats.total().count, 13U);
+
+  stats.clear();
+  BOOST_CHECK_EQUAL(stats.total().count, 0U);
+  BOOST_CHECK(stats.options().empty());
+
+  unlink(fname);
+}
+
+// ==============================================================
+
+BOOST_AUTO_TEST_CASE( cmdline_test_optfile_reload )
+{
+  char fname1[] = "/tmp/AppCmdLineTest-XXXXXX";
+  char fname2[] = "/tmp/AppCmdLineTest-XXXXXX";
+  int fd = mkstemp(fname1);
+  BOOST_REQUIRE(fd >= 0);
+  close(fd);
+  fd = mkstemp(fname2);
+  BOOST_REQUIRE(fd >= 0);
+  close(fd);
+  {
+    std::ofstream out(fname1);
+    out << "number1 = 100\n"
+        << "number2 = 200\n"
+        << "list = a,b\n";
+  }
+  {
+    std::ofstream out(fname2);
+    out << "name = first\n"
+        << "list = c\n";
+  }
+
+  AppCmdLine cmdline( "command" ) ;
+  AppCmdOptList<std::string> optFile(cmdline, "o,options", "path", "options file");
+  cmdline.setOptionsFile(optFile);
+  AppCmdOptIncr optVerbose(cmdline, "v,verbose", "make more noise", 0 );
+  AppCmdOpt<int> optInt1(cmdline, "x,number1", "number", "some number", 1 ) ;
+  AppCmdOpt<int> optInt2(cmdline, "y,number2", "number", "some number", 2 ) ;
+  AppCmdOpt<std::string> optName(cmdline, "name", "string", "some string", "" ) ;
+  AppCmdOptList<std::string> optList(cmdline, "l,list", "string", "list of strings" ) ;
+
+  // nothing to reload before parse
+  BOOST_CHECK(cmdline.reloadOptionsFiles().empty());
+
+  const char* args[] = { "", "-o", fname1, "-o", fname2, "-y", "5" } ;
+  BOOST_CHECK_NO_THROW(cmdline.parse(7, args));
+  BOOST_CHECK_EQUAL(optInt1.value(), 100);
+  BOOST_CHECK_EQUAL(optInt2.value(), 5);
+  BOOST_CHECK_EQUAL(optName.value(), "first");
+  BOOST_CHECK_EQUAL(optList.size(), 3U);
+
+  // files did not change
+  BOOST_CHECK(cmdline.reloadOptionsFiles().empty());
+
+  // rewrite the first file with the same contents
+  {
+    std::ofstream out(fname1);
+    out << "number1 = 100\n"
+        << "number2 = 200\n"
+        << "list = a,b\n";
+  }
+  BOOST_CHECK(cmdline.reloadOptionsFiles().empty());
+
+  // change the first file: number1 changes, number2 is given on command line,
+  // one list item changes, verbose is added
+  {
+    std::ofstream out(fname1);
+    out << "number1 = 101\n"
+        << "number2 = 201\n"
+        << "list = a,x\n"
+        << "verbose\n";
+  }
+  std::vector<AppCmdOptBase*> changed = cmdline.reloadOptionsFiles();
+  BOOST_CHECK_EQUAL(changed.size(), 3U);
+  BOOST_CHECK(std::find(changed.begin(), changed.end(), &optInt1) != changed.end());
+  BOOST_CHECK(std::find(changed.begin(), changed.end(), &optList) != changed.end());
+  BOOST_CHECK(std::find(changed.begin(), changed.end(), &optVerbose) != changed.end());
+  BOOST_CHECK_EQUAL(optInt1.value(), 101);
+  BOOST_CHECK_EQUAL(optInt2.value(), 5);
+  BOOST_CHECK_EQUAL(optVerbose.value(), 1);
+  BOOST_REQUIRE_EQUAL(optList.size(), 3U);
+  BOOST_CHECK_EQUAL(optList.value()[1], "x");
+  BOOST_CHECK_EQUAL(optList.value()[2], "c");
+  // option from unchanged file is not touched
+  BOOST_CHECK_EQUAL(optName.value(), "first");
+
+  // removed lines reset options to defaults
+  {
+    std::ofstream out(fname2);
+    out << "list = c\n";
+  }
+  changed = cmdline.reloadOptionsFiles();
+  BOOST_REQUIRE_EQUAL(changed.size(), 1U);
+  BOOST_CHECK_EQUAL(changed[0], &optName);
+  BOOST_CHECK_EQUAL(optName.value(), "");
+
+  // bad value throws and no option is changed, next reload applies the change again
+  {
+    std::ofstream out(fname2);
+    out << "verbose\n"
+        << "number1 = x\n";
+  }
+  BOOST_CHECK_THROW(cmdline.reloadOptionsFiles(), AppCmdException);
+  BOOST_CHECK_EQUAL(optVerbose.value(), 1);
+  BOOST_CHECK_EQUAL(optInt1.value(), 101);
+  BOOST_CHECK_EQUAL(optList.size(), 3U);
+  {
+    std::ofstream out(fname2);
+    out << "number1 = 7\n";
+  }
+  changed = cmdline.reloadOptionsFiles();
+  BOOST_CHECK_EQUAL(changed.size(), 2U);
+  BOOST_CHECK_EQUAL(optInt1.value(), 7);
+  BOOST_REQUIRE_EQUAL(optList.size(), 2U);
+
+  // unknown option and missing file
+  {
+    std::ofstream out(fname2);
+    out << "unknown = 7\n";
+  }
+  BOOST_CHECK_THROW(cmdline.reloadOptionsFiles(), AppCmdException);
+  unlink(fname2);
+  BOOST_CHECK_THROW(cmdline.reloadOptionsFiles(), AppCmdException);
+
+  unlink(fname1);
+}
+
+// ==============================================================
+
+BOOST_AUTO_TEST_CASE( cmdline_test_file_watcher )
+{
+  char dname[] = "/tmp/AppCmdLineTest-XXXXXX";
+  BOOST_REQUIRE(mkdtemp(dname));
+  const std::string dir(dname);
+  const std::string file1 = dir + "/file1.opt";
+  const std::string file2 = dir + "/file2.opt";
+  const std::string other = dir + "/other.opt";
+  std::ofstream(file1.c_str()) << "number = 1\n";
+
+  AppFileWatcher watcher(0.05);
+  BOOST_CHECK(watcher.wait(0).empty());
+  BOOST_CHECK(watcher.watch(file1));
+  BOOST_CHECK(watcher.watch(file2));
+  BOOST_CHECK(not watcher.watch(dir + "/missing/file"));
+  BOOST_CHECK_EQUAL(watcher.files().size(), 2U);
+
+  // nothing changed yet
+  BOOST_CHECK(watcher.wait(0).empty());
+
+  // one file changes
+  std::ofstream(file1.c_str()) << "number = 2\n";
+  std::vector<std::string> changed = watcher.wait(5);
+  BOOST_REQUIRE_EQUAL(changed.size(), 1U);
+  BOOST_CHECK_EQUAL(changed[0], file1);
+  BOOST_CHECK(watcher.wait(0).empty());
+
+  // burst of changes to both files is reported at once, file2 is created by rename
+  std::ofstream(file1.c_str()) << "number = 3\n";
+  std::ofstream(other.c_str()) << "number = 4\n";
+  BOOST_REQUIRE(rename(other.c_str(), file2.c_str()) == 0);
+  changed = watcher.wait(5);
+  BOOST_REQUIRE_EQUAL(changed.size(), 2U);
+  BOOST_CHECK_EQUAL(changed[0], file1);
+  BOOST_CHECK_EQUAL(changed[1], file2);
+
+  // other files in the same directory are not reported
+  std::ofstream(other.c_str()) << "number = 5\n";
+  BOOST_CHECK(watcher.wait(0.2).empty());
+
+  watcher.clear();
+  std::ofstream(file1.c_str()) << "number = 6\n";
+  BOOST_CHECK(watcher.wait(0.1).empty());
+
+  unlink(file1.c_str());
+  unlink(file2.c_str());
+  unlink(other.c_str());
+  rmdir(dname);
+}
+
+// ==============================================================
+
+BOOST_AUTO_TEST_CASE( cmdline_test_optfile_include )
+{
+  char dname[] = "/tmp/AppCmdLineTest-XXXXXX";
+  BOOST_REQUIRE(mkdtemp(dname));
+  const std::string dir(dname);
+  mkdir((dir + "/sub").c_str(), 0755);
+  std::ofstream((dir + "/common.opt").c_str()) << "number1 = 100\nlist = a\n";
+  std::ofstream((dir + "/sub/inner.opt").c_str()) << "# relative to this file\n@include ../common.opt\nlist = b\n";
+  std::ofstream((dir + "/top1.opt").c_str()) << "@include sub/inner.opt\nnumber2 = 5\n";
+  std::ofstream((dir + "/top2.opt").c_str()) << "@include = " << dir << "/common.opt\nname = x\n";
+
+  AppCmdLine cmdline( "command" ) ;
+  AppCmdOptList<std::string> optFile(cmdline, "o,options", "path", "options file");
+  cmdline.setOptionsFile(optFile);
+  AppCmdOpt<int> optInt1(cmdline, "x,number1", "number", "some number", 1 ) ;
+  AppCmdOpt<int> optInt2(cmdline, "y,number2", "number", "some number", 2 ) ;
+  AppCmdOpt<std::string> optName(cmdline, "name", "string", "some string", "" ) ;
+  AppCmdOptList<std::string> optList(cmdline, "l,list", "string", "list of strings" ) ;
+
+  const std::string top1 = dir + "/top1.opt";
+  const std::string top2 = dir + "/top2.opt";
+  const char* args[] = { "", "-o", top1.c_str(), "-o", top2.c_str() } ;
+  BOOST_CHECK_NO_THROW(cmdline.parse(5, args));
+  BOOST_CHECK_EQUAL(optInt1.value(), 100);
+  BOOST_CHECK_EQUAL(optInt2.value(), 5);
+  BOOST_CHECK_EQUAL(optName.value(), "x");
+  BOOST_REQUIRE_EQUAL(optList.size(), 3U);
+  BOOST_CHECK_EQUAL(optList.value()[0], "a");
+  BOOST_CHECK_EQUAL(optList.value()[1], "b");
+  BOOST_CHECK_EQUAL(optList.value()[2], "a");
+
+  // included files are reported and watched for changes
+  std::vector<std::string> files = cmdline.optionsFilesRead();
+  BOOST_CHECK_EQUAL(files.size(), 4U);
+  std::ofstream((dir + "/common.opt").c_str()) << "number1 = 200\nlist = a\n";
+  std::vector<AppCmdOptBase*> changed = cmdline.reloadOptionsFiles();
+  BOOST_REQUIRE_EQUAL(changed.size(), 1U);
+  BOOST_CHECK_EQUAL(changed[0], &optInt1);
+  BOOST_CHECK_EQUAL(optInt1.value(), 200);
+
+  // recursive includes
+  std::ofstream((dir + "/self.opt").c_str()) << "number1 = 1\n@include self.opt\n";
+  std::ofstream((dir + "/cycle1.opt").c_str()) << "@include cycle2.opt\n";
+  std::ofstream((dir + "/cycle2.opt").c_str()) << "@include sub/../cycle1.opt\n";
+  const std::string self = dir + "/self.opt";
+  const std::string cycle = dir + "/cycle1.opt";
+  const char* args2[] = { "", "-o", self.c_str() } ;
+  BOOST_CHECK_THROW(cmdline.parse(3, args2), AppCmdException);
+  args2[2] = cycle.c_str();
+  BOOST_CHECK_THROW(cmdline.parse(3, args2), AppCmdException);
+
+  // missing file name or missing file
+  const std::string bad = dir + "/bad.opt";
+  std::ofstream(bad.c_str()) << "@include\n";
+  args2[2] = bad.c_str();
+  BOOST_CHECK_THROW(cmdline.parse(3, args2), AppCmdException);
+  std::ofstream(bad.c_str()) << "@include missing.opt\n";
+  BOOST_CHECK_THROW(cmdline.parse(3, args2), AppCmdException);
+
+  // same file included twice, but not recursively, is fine
+  std::ofstream(bad.c_str()) << "@include common.opt\n@include common.opt\n";
+  BOOST_CHECK_NO_THROW(cmdline.parse(3, args2));
+  BOOST_CHECK_EQUAL(optList.size(), 2U);
+
+  const char* names[] = { "common.opt", "sub/inner.opt", "top1.opt", "top2.opt", "self.opt",
+                          "cycle1.opt", "cycle2.opt", "bad.opt" };
+  for (unsigned i = 0; i != sizeof names / sizeof names[0]; ++ i) unlink((dir + "/" + names[i]).c_str());
+  rmdir((dir + "/sub").c_str());
+  rmdir(dname);
+}
+
+// ==============================================================
+
+BOOST_AUTO_TEST_CASE( cmdline_test_optfile_parallel )
+{
+  char dname[] = "/tmp/AppCmdLineTest-XXXXXX";
+  BOOST_REQUIRE(mkdtemp(dname));
+  const std::string dir(dname);
+
+  const unsigned nFiles = 8;
+  std::vector<std::string> paths;
+  for (unsigned i = 0; i != nFiles; ++ i) {
+    paths.push_back(dir + "/file" + std::string(1, char('0' + i)) + ".opt");
+    std::ofstream(paths.back().c_str()) << "number1 = " << i << "\nlist = " << i << "\n";
+  }
+  std::ofstream((dir + "/last.opt").c_str()) << "number2 = 42\n";
+  paths.push_back(dir + "/last.opt");
+
+  AppCmdLine cmdline( "command" ) ;
+  AppCmdOptList<std::string> optFile(cmdline, "o,options", "path", "options file");
+  cmdline.setOptionsFile(optFile);
+  AppCmdOpt<int> optInt1(cmdline, "x,number1", "number", "some number", -1 ) ;
+  AppCmdOpt<int> optInt2(cmdline, "y,number2", "number", "some number", -1 ) ;
+  AppCmdOptList<std::string> optList(cmdline, "l,list", "string", "list of strings" ) ;
+
+  std::vector<std::string> words;
+  for (unsigned i = 0; i != paths.size(); ++ i) {
+    words.push_back("-o");
+    words.push_back(paths[i]);
+  }
+
+  // results do not depend on the number of threads, last file wins
+  const unsigned threads[] = { 0, 1, 3, 100 };
+  for (unsigned t = 0; t != sizeof threads / sizeof threads[0]; ++ t) {
+    cmdline.setOptionsFileThreads(threads[t]);
+    BOOST_CHECK_NO_THROW(cmdline.parse(words.begin(), words.end()));
+    BOOST_CHECK_EQUAL(optInt1.value(), int(nFiles-1));
+    BOOST_CHECK_EQUAL(optInt2.value(), 42);
+    BOOST_REQUIRE_EQUAL(optList.size(), nFiles);
+    for (unsigned i = 0; i != nFiles; ++ i) {
+      BOOST_CHECK_EQUAL(optList.value()[i], std::string(1, char('0' + i)));
+    }
+  }
+
+  // missing file in the middle
+  std::vector<std::string> words2(words);
+  words2[5] = dir + "/missing.opt";
+  cmdline.setOptionsFileThreads(0);
+  BOOST_CHECK_THROW(cmdline.parse(words2.begin(), words2.end()), AppCmdException);
+
+  for (unsigned i = 0; i != paths.size(); ++ i) unlink(paths[i].c_str());
+  rmdir(dname);
+}
+
+// ==============================================================
+
+BOOST_AUTO_TEST_CASE( cmdline_test_optfile_in_args )
+{
+  AppCmdLine cmdline( "command" ) ;
+  AppCmdOptList<std::string> optFile(cmdline, "o,options", "path", "options file");
+  AppCmdOpt<int> optInt(cmdline, "x,number", "number", "some number", 0 ) ;
+
+  const char* args[] = { "", "-o", "a.opt", "-ob.opt", "--options", "c.opt,d.opt", "-x1",
+                         "--options=e.opt", "--optionsX", "--", "-o", "f.opt" } ;
+  BOOST_CHECK(cmdline.optionsFilesInArgs(12, args).empty());
+
+  cmdline.setOptionsFile(optFile);
+  std::vector<std::string> files = cmdline.optionsFilesInArgs(12, args);
+  BOOST_REQUIRE_EQUAL(files.size(), 5U);
+  BOOST_CHECK_EQUAL(files[0], "a.opt");
+  BOOST_CHECK_EQUAL(files[1], "b.opt");
+  BOOST_CHECK_EQUAL(files[2], "c.opt");
+  BOOST_CHECK_EQUAL(files[3], "d.opt");
+  BOOST_CHECK_EQUAL(files[4], "e.opt");
+  BOOST_CHECK(not optFile.valueChanged());
+}
+
+// ==============================================================
+
+BOOST_AUTO_TEST_CASE( cmdline_test_snapshot )
+{
+  char fname[] = "/tmp/AppCmdLineTest-XXXXXX";
+  int fd = mkstemp(fname);
+  BOOST_REQUIRE(fd >= 0);
+  close(fd);
+  std::ofstream(fname) << "number2 = 5\nname = with spaces\nlist = c\n";
+
+  std::string snapshot;
+  {
+    AppCmdLine cmdline( "command" ) ;
+    AppCmdOptList<std::string> optFile(cmdline, "o,options", "path", "options file");
+    cmdline.setOptionsFile(optFile);
+    AppCmdOpt<int> optInt1(cmdline, "x,number1", "number", "some number", 1 ) ;
+    AppCmdOpt<int> optInt2(cmdline, "y,number2", "number", "some number", 2 ) ;
+    AppCmdOpt<std::string> optName(cmdline, "name", "string", "some string", "" ) ;
+    AppCmdOptList<std::string> optList(cmdline, "l,list", "string", "list of strings" ) ;
+    AppCmdOptBool optBool(cmdline, "b,bool", "some flag" ) ;
+    AppCmdArgList<std::string> args(cmdline, "args", "arguments");
+
+    const char* argv[] = { "", "-o", fname, "-b", "-l", "a,b", "--number1=10", "arg 1", "\narg2" } ;
+    std::ostringstream out;
+    BOOST_CHECK_THROW(cmdline.saveSnapshot(out), AppCmdException);
+
+    cmdline.setRecordValues(true);
+    BOOST_CHECK_NO_THROW(cmdline.parse(9, argv));
+    BOOST_CHECK_NO_THROW(cmdline.saveSnapshot(out));
+    snapshot = out.str();
+    BOOST_CHECK(snapshot.find("opt number1 9:cmdline:6 2:10\n") != std::string::npos);
+    std::ostringstream name;
+    name << "opt name " << std::strlen(fname) + 7 << ":file:" << fname << ":2 11:with spaces\n";
+    BOOST_CHECK(snapshot.find(name.str()) != std::string::npos);
+    BOOST_CHECK(snapshot.find("def help\n") != std::string::npos);
+  }
+
+  // other parser with the same options
+  AppCmdLine cmdline( "command" ) ;
+  AppCmdOptList<std::string> optFile(cmdline, "o,options", "path", "options file");
+  cmdline.setOptionsFile(optFile);
+  AppCmdOpt<int> optInt1(cmdline, "x,number1", "number", "some number", 1 ) ;
+  AppCmdOpt<int> optInt2(cmdline, "y,number2", "number", "some number", 2 ) ;
+  AppCmdOpt<std::string> optName(cmdline, "name", "string", "some string", "" ) ;
+  AppCmdOptList<std::string> optList(cmdline, "l,list", "string", "list of strings" ) ;
+  AppCmdOptBool optBool(cmdline, "b,bool", "some flag" ) ;
+  AppCmdArgList<std::string> args(cmdline, "args", "arguments");
+
+  // options file is not read again
+  unlink(fname);
+  std::istringstream in(snapshot);
+  BOOST_CHECK_NO_THROW(cmdline.loadSnapshot(in));
+  BOOST_CHECK_EQUAL(optInt1.value(), 10);
+  BOOST_CHECK_EQUAL(optInt2.value(), 5);
+  BOOST_CHECK_EQUAL(optName.value(), "with spaces");
+  BOOST_CHECK(optBool.value());
+  BOOST_REQUIRE_EQUAL(optList.size(), 2U);
+  BOOST_CHECK_EQUAL(optList.value()[0], "a");
+  BOOST_CHECK_EQUAL(optList.value()[1], "b");
+  BOOST_REQUIRE_EQUAL(args.size(), 2U);
+  BOOST_CHECK_EQUAL(*args.begin(), "arg 1");
+  BOOST_CHECK_EQUAL(*(++args.begin()), "\narg2");
+
+  BOOST_CHECK_EQUAL(cmdline.provenance(optInt1).word, 6U);
+  BOOST_CHECK_EQUAL(cmdline.provenance(optName).file, fname);
+  BOOST_CHECK_EQUAL(cmdline.provenance(optName).line, 2U);
+
+  std::ostringstream out;
+  cmdline.saveSnapshot(out);
+  BOOST_CHECK_EQUAL(out.str(), snapshot);
+
+  // broken snapshots do not change options
+  std::istringstream bad1("AppCmdSnapshot 1\nopt unknown 9:cmdline:1 0:\n");
+  BOOST_CHECK_THROW(cmdline.loadSnapshot(bad1), AppCmdException);
+  std::istringstream bad2("AppCmdSnapshot 1\nopt name 9:cmdline:1 100:short\n");
+  BOOST_CHECK_THROW(cmdline.loadSnapshot(bad2), AppCmdException);
+  std::istringstream bad3("something else");
+  BOOST_CHECK_THROW(cmdline.loadSnapshot(bad3), AppCmdException);
+  BOOST_CHECK_EQUAL(optInt1.value(), 10);
+}
+
+// ==============================================================
+
+BOOST_AUTO_TEST_CASE( cmdline_test_provenance )
+{
+  char dname[] = "/tmp/AppCmdLineTest-XXXXXX";
+  BOOST_REQUIRE(mkdtemp(dname));
+  const std::string dir(dname);
+  const std::string top = dir + "/top.opt";
+  const std::string inc = dir + "/inc.opt";
+  std::ofstream(inc.c_str()) << "# comment\nlist = b\n";
+  std::ofstream(top.c_str()) << "number1 = 5\nnumber2 = 6\nlist = a\n@include inc.opt\n";
+
+  AppCmdLine cmdline( "command" ) ;
+  AppCmdOptList<std::string> optFile(cmdline, "o,options", "path", "options file");
+  cmdline.setOptionsFile(optFile);
+  AppCmdOpt<int> optInt1(cmdline, "x,number1", "number", "some number", 1 ) ;
+  AppCmdOpt<int> optInt2(cmdline, "y,number2", "number", "some number", 2 ) ;
+  AppCmdOpt<std::string> optName(cmdline, "name", "string", "some string", "" ) ;
+  AppCmdOptList<std::string> optList(cmdline, "l,list", "string", "list of strings" ) ;
+
+  cmdline.setRecordValues(true);
+  const char* args[] = { "", "-o", top.c_str(), "-x", "10" } ;
+  BOOST_CHECK_NO_THROW(cmdline.parse(5, args));
+
+  AppCmdLine::Provenance prov = cmdline.provenance(optInt1);
+  BOOST_CHECK_EQUAL(prov.source, AppCmdLine::Provenance::CommandLine);
+  BOOST_CHECK_EQUAL(prov.word, 3U);
+  BOOST_CHECK_EQUAL(prov.count, 1U);
+
+  prov = cmdline.provenance(optInt2);
+  BOOST_CHECK_EQUAL(prov.source, AppCmdLine::Provenance::OptionsFile);
+  BOOST_CHECK_EQUAL(prov.file, top);
+  BOOST_CHECK_EQUAL(prov.line, 2U);
+
+  // last value comes from included file
+  prov = cmdline.provenance(optList);
+  BOOST_CHECK_EQUAL(prov.source, AppCmdLine::Provenance::OptionsFile);
+  BOOST_CHECK_EQUAL(prov.file, inc);
+  BOOST_CHECK_EQUAL(prov.line, 2U);
+  BOOST_CHECK_EQUAL(prov.count, 2U);
+
+  BOOST_CHECK_EQUAL(cmdline.provenance(optName).source, AppCmdLine::Provenance::Default);
+
+  std::ostringstream out;
+  cmdline.dumpProvenance(out);
+  BOOST_CHECK(out.str().find("number2 file:" + top + ":2\n") != std::string::npos);
+  BOOST_CHECK(out.str().find("list file:" + inc + ":2 (2 values)\n") != std::string::npos);
+  BOOST_CHECK(out.str().find("name default\n") != std::string::npos);
+
+  // reload keeps file and line of values from included file
+  std::ofstream(inc.c_str()) << "# comment\n\nlist = c\n";
+  BOOST_CHECK_EQUAL(cmdline.reloadOptionsFiles().size(), 1U);
+  prov = cmdline.provenance(optList);
+  BOOST_CHECK_EQUAL(prov.source, AppCmdLine::Provenance::OptionsFile);
+  BOOST_CHECK_EQUAL(prov.file, inc);
+  BOOST_CHECK_EQUAL(prov.line, 3U);
+  BOOST_CHECK_EQUAL(prov.count, 2U);
+  std::ostringstream snapshot;
+  cmdline.saveSnapshot(snapshot);
+  BOOST_CHECK(snapshot.str().find("file:" + top + ":3") != std::string::npos);
+  BOOST_CHECK(snapshot.str().find("file:" + inc + ":3") != std::string::npos);
+
+  // unknown option
+  AppCmdOpt<int> other("other", "number", "some number", 0 ) ;
+  BOOST_CHECK_THROW(cmdline.provenance(other), AppCmdException);
+
+  unlink(inc.c_str());
+  unlink(top.c_str());
+  rmdir(dname);
+}
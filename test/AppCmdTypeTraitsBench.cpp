@@ -0,0 +1,175 @@
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Benchmark for number conversion in AppCmdTypeTraits. Compares time to
+//	parse large AppCmdOptList<double> and AppCmdOptList<int> values with the
+//	time of the same conversion done with strtod/strtol.
+//
+// Author List:
+//      Andy Salnikov
+//
+//------------------------------------------------------------------------
+
+//---------------
+// C++ Headers --
+//---------------
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <sys/time.h>
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+#include "AppUtils/AppCmdLine.h"
+#include "AppUtils/AppCmdOptList.h"
+#include "AppUtils/AppCmdTypeTraits.h"
+
+using namespace AppUtils ;
+
+//-----------------------------------------------------------------------
+// Local Macros, Typedefs, Structures, Unions and Forward Declarations --
+//-----------------------------------------------------------------------
+
+namespace {
+
+double now()
+{
+  struct timeval tv;
+  gettimeofday(&tv, 0);
+  return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+// same conversion as done by AppCmdTypeTraits<double> before it stopped using strtod
+double strtodConvert(const std::string& str)
+{
+  const char* nptr = str.c_str() ;
+  char* end ;
+  errno = 0;
+  double val = std::strtod ( nptr, &end ) ;
+  if (end==nptr || *end != '\0' || (errno != 0 && val == 0)) throw AppCmdTypeCvtException ( str, "double" ) ;
+  return val ;
+}
+
+// same conversion as done by AppCmdTypeTraits<long> before it stopped using strtol
+long strtolConvert(const std::string& str)
+{
+  const char* nptr = str.c_str() ;
+  char* end ;
+  errno = 0;
+  long val = std::strtol ( nptr, &end, 0 ) ;
+  if (end==nptr || *end != '\0' || (errno != 0 && val == 0)) throw AppCmdTypeCvtException ( str, "long" ) ;
+  return val ;
+}
+
+// split list the same way AppCmdOptList does and convert each item with a function
+template <typename T, typename Func>
+void splitConvert(const std::string& value, std::vector<T>& res, Func func)
+{
+  std::string::const_iterator pos = value.begin() ;
+  do {
+    std::string::const_iterator pos1 = std::find ( pos, value.end(), ',' ) ;
+    res.push_back ( T(func ( std::string ( pos, pos1 ) )) ) ;
+    pos = pos1 ;
+    if ( pos != value.end() ) ++ pos ;
+  } while ( pos != value.end() ) ;
+}
+
+// run one benchmark, prints time per item in nanoseconds
+template <typename T, typename Func>
+void bench(const char* name, const std::string& arg, size_t nItems, Func func, int nRepeat)
+{
+  // time of the parser
+  double best = 1e30;
+  for (int i = 0; i != nRepeat; ++ i) {
+    AppCmdLine cmdline("bench");
+    AppCmdOptList<T> opt(cmdline, "l,list", "list", "list of values");
+    const char* argv[] = { "bench", "-l", arg.c_str() };
+    double t0 = now();
+    cmdline.parse(3, argv);
+    double t1 = now();
+    if (opt.size() != nItems) std::abort();
+    if (t1 - t0 < best) best = t1 - t0;
+  }
+
+  // time of the same split with the C library conversion
+  double bestRef = 1e30;
+  for (int i = 0; i != nRepeat; ++ i) {
+    std::vector<T> res;
+    double t0 = now();
+    splitConvert(arg, res, func);
+    double t1 = now();
+    if (res.size() != nItems) std::abort();
+    if (t1 - t0 < bestRef) bestRef = t1 - t0;
+  }
+
+  std::printf("%-24s items=%-8lu AppCmdOptList:    %7.1f ns/item   strtoX: %7.1f ns/item   speedup: %.2f\n",
+      name, (unsigned long)nItems, best / nItems * 1e9, bestRef / nItems * 1e9, bestRef / best);
+}
+
+// time conversion only, without splitting the list
+template <typename T, typename Func>
+void benchConvert(const char* name, const std::vector<std::string>& items, Func func, int nRepeat)
+{
+  double best = 1e30;
+  double bestRef = 1e30;
+  T sum = T();
+  T sumRef = T();
+  for (int i = 0; i != nRepeat; ++ i) {
+    double t0 = now();
+    for (std::vector<std::string>::const_iterator it = items.begin(); it != items.end(); ++ it) {
+      sum += AppCmdTypeTraits<T>::fromString(*it);
+    }
+    double t1 = now();
+    for (std::vector<std::string>::const_iterator it = items.begin(); it != items.end(); ++ it) {
+      sumRef += T(func(*it));
+    }
+    double t2 = now();
+    if (t1 - t0 < best) best = t1 - t0;
+    if (t2 - t1 < bestRef) bestRef = t2 - t1;
+  }
+  if (sum != sumRef) std::abort();
+
+  std::printf("%-24s items=%-8lu AppCmdTypeTraits: %7.1f ns/item   strtoX: %7.1f ns/item   speedup: %.2f\n",
+      name, (unsigned long)items.size(), best / items.size() * 1e9, bestRef / items.size() * 1e9, bestRef / best);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  size_t nItems = argc > 1 ? std::strtoul(argv[1], 0, 0) : 1000000;
+  const int nRepeat = 5;
+
+  // typical floating point numbers: calibration constants, pixel coordinates
+  std::string dlist;
+  std::string ilist;
+  std::vector<std::string> ditems;
+  std::vector<std::string> iitems;
+  char buf[64];
+  std::srand(12345);
+  for (size_t i = 0; i != nItems; ++ i) {
+    if (i) {
+      dlist += ',';
+      ilist += ',';
+    }
+    std::snprintf(buf, sizeof buf, "%.*g", 3 + std::rand() % 13, (std::rand() - RAND_MAX/2) / 1000.);
+    dlist += buf;
+    ditems.push_back(buf);
+    std::snprintf(buf, sizeof buf, "%d", std::rand() % 10000000);
+    ilist += buf;
+    iitems.push_back(buf);
+  }
+
+  benchConvert<double>("double", ditems, strtodConvert, nRepeat);
+  benchConvert<int>("int", iitems, strtolConvert, nRepeat);
+
+  bench<double>("AppCmdOptList<double>", dlist, nItems, strtodConvert, nRepeat);
+  bench<int>("AppCmdOptList<int>", ilist, nItems, strtolConvert, nRepeat);
+}
@@ -10,11 +10,23 @@
 //---------------
 // C++ Headers --
 //---------------
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <boost/filesystem.hpp>
 
 //-------------------------------
 // Collaborating Class Headers --
 //-------------------------------
+#include "AppUtils/AppDataFile.h"
 #include "AppUtils/AppDataPath.h"
+#include "AppUtils/AppPrefetch.h"
 using namespace AppUtils ;
 
 #define BOOST_TEST_MODULE AppDataPathTest
@@ -40,3 +52,290 @@ BOOST_AUTO_TEST_CASE( test_not_exist )
   AppDataPath path("AppUtils/file-for-AppDataPath-unit-test-does-not-exist");
   BOOST_CHECK(path.path().empty()) ;
 }
+
+// ==============================================================
+
+BOOST_AUTO_TEST_CASE( test_prefetch )
+{
+  const std::string exists = "AppUtils/file-for-AppDataPath-unit-test";
+  const std::string missing = "AppUtils/file-for-AppDataPath-unit-test-does-not-exist";
+
+  AppPrefetch prefetch;
+  prefetch.addDataPath(exists);
+  prefetch.addDataPath(missing);
+  prefetch.addFile("/file-for-AppDataPath-unit-test-does-not-exist");
+  prefetch.start();
+  BOOST_CHECK_EQUAL(prefetch.dataPath(exists), AppDataPath(exists).path());
+  BOOST_CHECK(prefetch.dataPath(missing).empty());
+
+  // paths which were not prefetched are resolved too
+  BOOST_CHECK_EQUAL(prefetch.dataPath(exists + "/.."), AppDataPath(exists + "/..").path());
+
+  // paths which were not prefetched do not wait for background thread,
+  // which is blocked here in opening a fifo
+  char fifo[] = "/tmp/AppDataPathTest-XXXXXX";
+  BOOST_REQUIRE(mkdtemp(fifo));
+  const std::string fifoPath = std::string(fifo) + "/fifo";
+  BOOST_REQUIRE_EQUAL(mkfifo(fifoPath.c_str(), 0600), 0);
+  {
+    AppPrefetch blocked;
+    blocked.addFile(fifoPath);
+    blocked.addDataPath(exists);
+    blocked.start();
+    BOOST_CHECK_EQUAL(blocked.dataPath(missing), "");
+    // unblock background thread
+    const int fd = open(fifoPath.c_str(), O_WRONLY);
+    BOOST_CHECK(fd >= 0);
+    if (fd >= 0) close(fd);
+    BOOST_CHECK_EQUAL(blocked.dataPath(exists), AppDataPath(exists).path());
+  }
+  unlink(fifoPath.c_str());
+  rmdir(fifo);
+}
+
+// ==============================================================
+
+BOOST_AUTO_TEST_CASE( test_cache )
+{
+  const std::string exists = "AppUtils/file-for-AppDataPath-unit-test";
+  const std::string missing = "AppUtils/file-for-AppDataPath-unit-test-does-not-exist";
+
+  AppDataPath::clearCache();
+  const std::string path = AppDataPath(exists).path();
+  BOOST_CHECK_EQUAL(AppDataPath(exists).path(), path);
+  BOOST_CHECK(AppDataPath(missing).path().empty());
+  BOOST_CHECK(AppDataPath(missing).path().empty());
+
+  AppDataPath::CacheStats stats = AppDataPath::cacheStats();
+  BOOST_CHECK_EQUAL(stats.hits, 2U);
+  BOOST_CHECK_EQUAL(stats.misses, 2U);
+  BOOST_CHECK_EQUAL(stats.size, 2U);
+
+  // cache is dropped when SIT_DATA changes
+  BOOST_REQUIRE(getenv("SIT_DATA"));
+  const std::string dataPath = getenv("SIT_DATA");
+  setenv("SIT_DATA", ("/AppDataPathTest-does-not-exist:" + dataPath).c_str(), 1);
+  BOOST_CHECK_EQUAL(AppDataPath(exists).path(), path);
+  stats = AppDataPath::cacheStats();
+  BOOST_CHECK_EQUAL(stats.misses, 3U);
+  BOOST_CHECK_EQUAL(stats.size, 1U);
+  setenv("SIT_DATA", dataPath.c_str(), 1);
+}
+
+// ==============================================================
+
+BOOST_AUTO_TEST_CASE( test_dir_index )
+{
+  char dname[] = "/tmp/AppDataPathTest-XXXXXX";
+  BOOST_REQUIRE(mkdtemp(dname));
+  const std::string root(dname);
+  mkdir((root + "/Pkg").c_str(), 0755);
+  mkdir((root + "/Pkg/sub").c_str(), 0755);
+  std::ofstream((root + "/Pkg/a.data").c_str()) << "a\n";
+  std::ofstream((root + "/Pkg/b.data").c_str()) << "b\n";
+  std::ofstream((root + "/Pkg/sub/c.data").c_str()) << "c\n";
+  BOOST_REQUIRE(symlink("does-not-exist", (root + "/Pkg/dangling").c_str()) == 0);
+
+  BOOST_REQUIRE(getenv("SIT_DATA"));
+  const std::string dataPath = getenv("SIT_DATA");
+  setenv("SIT_DATA", root.c_str(), 1);
+  AppDataPath::clearCache();
+
+  BOOST_CHECK_EQUAL(AppDataPath("Pkg/a.data").path(), root + "/Pkg/a.data");
+  BOOST_CHECK_EQUAL(AppDataPath("Pkg/b.data").path(), root + "/Pkg/b.data");
+  BOOST_CHECK(AppDataPath("Pkg/missing.data").path().empty());
+  BOOST_CHECK(AppDataPath("Other/x.data").path().empty());
+  BOOST_CHECK(AppDataPath("Pkg/a.data/x").path().empty());
+  // root and Pkg directories only
+  BOOST_CHECK_EQUAL(AppDataPath::cacheStats().listings, 2U);
+
+  BOOST_CHECK_EQUAL(AppDataPath("Pkg/sub/c.data").path(), root + "/Pkg/sub/c.data");
+  BOOST_CHECK_EQUAL(AppDataPath("Pkg/sub").path(), root + "/Pkg/sub");
+  BOOST_CHECK_EQUAL(AppDataPath::cacheStats().listings, 3U);
+
+  // these are checked with stat()
+  BOOST_CHECK(AppDataPath("Pkg/dangling").path().empty());
+  BOOST_CHECK(AppDataPath("Pkg/a.data/").path().empty());
+  BOOST_CHECK_EQUAL(AppDataPath("Pkg/sub/").path(), root + "/Pkg/sub/");
+  BOOST_CHECK_EQUAL(AppDataPath("Pkg/sub/../a.data").path(), root + "/Pkg/sub/../a.data");
+
+  setenv("SIT_DATA", dataPath.c_str(), 1);
+  AppDataPath::clearCache();
+  const char* names[] = { "/Pkg/a.data", "/Pkg/b.data", "/Pkg/sub/c.data", "/Pkg/dangling" };
+  for (unsigned i = 0; i != sizeof names / sizeof names[0]; ++ i) unlink((root + names[i]).c_str());
+  rmdir((root + "/Pkg/sub").c_str());
+  rmdir((root + "/Pkg").c_str());
+  rmdir(dname);
+}
+
+// ==============================================================
+
+BOOST_AUTO_TEST_CASE( test_manifest )
+{
+  char dname1[] = "/tmp/AppDataPathTest-XXXXXX";
+  char dname2[] = "/tmp/AppDataPathTest-XXXXXX";
+  BOOST_REQUIRE(mkdtemp(dname1));
+  BOOST_REQUIRE(mkdtemp(dname2));
+  const std::string root1(dname1);
+  const std::string root2(dname2);
+
+  // manifest lists files which do not exist, it is trusted
+  const std::string manifest = root1 + "/" + AppDataPath::manifestName;
+  std::ofstream(manifest.c_str()) << "AppDataPath-manifest 1\nPkg\nPkg/a.data\nPkg/b.data\nPkg/sub\nPkg/sub/c.data\nPkg2\n";
+  std::ofstream((root1 + "/not-in-manifest.data").c_str()) << "x\n";
+  std::ofstream((root2 + "/not-in-manifest.data").c_str()) << "x\n";
+
+  BOOST_REQUIRE(getenv("SIT_DATA"));
+  const std::string dataPath = getenv("SIT_DATA");
+  setenv("SIT_DATA", (root1 + ":" + root2).c_str(), 1);
+  AppDataPath::clearCache();
+
+  BOOST_CHECK_EQUAL(AppDataPath("Pkg/a.data").path(), root1 + "/Pkg/a.data");
+  BOOST_CHECK_EQUAL(AppDataPath("Pkg//b.data").path(), root1 + "/Pkg//b.data");
+  BOOST_CHECK_EQUAL(AppDataPath("Pkg/sub/c.data").path(), root1 + "/Pkg/sub/c.data");
+  BOOST_CHECK_EQUAL(AppDataPath("Pkg2").path(), root1 + "/Pkg2");
+  BOOST_CHECK(AppDataPath("Pkg/sub/d.data").path().empty());
+  BOOST_CHECK(AppDataPath("Pkg/a").path().empty());
+  BOOST_CHECK(AppDataPath("A").path().empty());
+  BOOST_CHECK(AppDataPath("Z").path().empty());
+  // trailing slash is checked with stat()
+  BOOST_CHECK(AppDataPath("Pkg/a.data/").path().empty());
+  // second root has no manifest
+  BOOST_CHECK_EQUAL(AppDataPath("not-in-manifest.data").path(), root2 + "/not-in-manifest.data");
+  BOOST_CHECK_EQUAL(AppDataPath::cacheStats().listings, 1U);
+
+  // invalid manifest is ignored
+  std::ofstream(manifest.c_str()) << "AppDataPath-manifest 1\nPkg/a.data";
+  AppDataPath::clearCache();
+  BOOST_CHECK(AppDataPath("Pkg/a.data").path().empty());
+  BOOST_CHECK_EQUAL(AppDataPath("not-in-manifest.data").path(), root1 + "/not-in-manifest.data");
+
+  setenv("SIT_DATA", dataPath.c_str(), 1);
+  AppDataPath::clearCache();
+  unlink(manifest.c_str());
+  unlink((root1 + "/not-in-manifest.data").c_str());
+  unlink((root2 + "/not-in-manifest.data").c_str());
+  rmdir(dname1);
+  rmdir(dname2);
+}
+
+// ==============================================================
+
+BOOST_AUTO_TEST_CASE( test_batch )
+{
+  char dname[] = "/tmp/AppDataPathTest-XXXXXX";
+  BOOST_REQUIRE(mkdtemp(dname));
+  const std::string root(dname);
+  mkdir((root + "/Pkg").c_str(), 0755);
+  std::vector<std::string> relPaths;
+  for (char c = 'a'; c != 'm'; ++ c) {
+    const std::string name = std::string("Pkg/") + c + ".data";
+    if (c % 2) std::ofstream((root + "/" + name).c_str()) << c << "\n";
+    relPaths.push_back(name);
+  }
+  relPaths.push_back("AppUtils/file-for-AppDataPath-unit-test");
+  relPaths.push_back("Pkg/a.data");
+  relPaths.push_back("Pkg/../Pkg/a.data");
+
+  BOOST_REQUIRE(getenv("SIT_DATA"));
+  const std::string dataPath = getenv("SIT_DATA");
+  setenv("SIT_DATA", (root + ":" + dataPath).c_str(), 1);
+
+  const unsigned threads[] = { 0, 1, 5 };
+  for (unsigned t = 0; t != sizeof threads / sizeof threads[0]; ++ t) {
+    AppDataPath::clearCache();
+    const std::vector<std::string> paths = AppDataPath::resolve(relPaths, threads[t]);
+    BOOST_CHECK_EQUAL(AppDataPath::cacheStats().misses, relPaths.size() - 1);
+
+    // same answers from cache
+    BOOST_REQUIRE_EQUAL(paths.size(), relPaths.size());
+    for (unsigned i = 0; i != relPaths.size(); ++ i) {
+      BOOST_CHECK_EQUAL(paths[i], AppDataPath(relPaths[i]).path());
+    }
+    BOOST_CHECK_EQUAL(AppDataPath::cacheStats().misses, relPaths.size() - 1);
+  }
+  BOOST_CHECK_EQUAL(AppDataPath::resolve(relPaths).at(0), root + "/Pkg/a.data");
+  BOOST_CHECK(AppDataPath::resolve(relPaths).at(1).empty());
+  BOOST_CHECK(not AppDataPath::resolve(relPaths).at(12).empty());
+
+  // stat() fails for too long name, batch throws like constructor does
+  const std::string tooLong = "../" + std::string(300, 'x');
+  BOOST_CHECK_THROW(AppDataPath(tooLong).path(), boost::filesystem::filesystem_error);
+  relPaths.push_back(tooLong);
+  for (unsigned t = 0; t != sizeof threads / sizeof threads[0]; ++ t) {
+    AppDataPath::clearCache();
+    BOOST_CHECK_THROW(AppDataPath::resolve(relPaths, threads[t]), boost::filesystem::filesystem_error);
+  }
+  relPaths.pop_back();
+
+  setenv("SIT_DATA", dataPath.c_str(), 1);
+  AppDataPath::clearCache();
+  for (unsigned i = 0; i != 12; ++ i) unlink((root + "/" + relPaths[i]).c_str());
+  rmdir((root + "/Pkg").c_str());
+  rmdir(dname);
+}
+
+// ==============================================================
+
+BOOST_AUTO_TEST_CASE( test_data_file )
+{
+  const std::string relPath = "AppUtils/file-for-AppDataPath-unit-test";
+  const unsigned long nMapped = AppDataFile::mappedFiles();
+  {
+    AppDataFile file1(relPath);
+    BOOST_REQUIRE(file1.valid());
+    BOOST_CHECK_EQUAL(AppDataFile::mappedFiles(), nMapped + 1);
+
+    std::ifstream in(AppDataPath(relPath).path().c_str());
+    const std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    BOOST_CHECK_EQUAL(file1.view(), contents);
+    BOOST_CHECK_EQUAL(file1.size(), contents.size());
+
+    // same file through different paths shares one mapping
+    const std::string path = AppDataPath(relPath).path();
+    const std::string::size_type pos = path.rfind('/');
+    AppDataFile file2 = AppDataFile::open(path.substr(0, pos) + "/./" + path.substr(pos + 1));
+    AppDataFile file3(file1);
+    BOOST_CHECK_EQUAL(file2.data(), file1.data());
+    BOOST_CHECK_EQUAL(file3.data(), file1.data());
+    BOOST_CHECK_EQUAL(file2.path(), file1.path());
+    BOOST_CHECK_EQUAL(AppDataFile::mappedFiles(), nMapped + 1);
+  }
+  BOOST_CHECK_EQUAL(AppDataFile::mappedFiles(), nMapped);
+
+  AppDataFile missing(relPath + "-does-not-exist");
+  BOOST_CHECK(not missing.valid());
+  BOOST_CHECK(missing.path().empty());
+  BOOST_CHECK_EQUAL(missing.size(), 0U);
+  BOOST_CHECK(missing.data());
+
+  // errors of AppDataPath are not thrown
+  AppDataFile tooLong("../" + std::string(300, 'x'));
+  BOOST_CHECK(not tooLong.valid());
+
+  // changed file gets new mapping, old one stays valid
+  char fname[] = "/tmp/AppDataFileTest-XXXXXX";
+  const int fd = mkstemp(fname);
+  BOOST_REQUIRE(fd >= 0);
+  close(fd);
+  AppDataFile empty = AppDataFile::open(fname);
+  BOOST_REQUIRE(empty.valid());
+  BOOST_CHECK_EQUAL(empty.size(), 0U);
+  std::ofstream(fname) << "new contents\n";
+  AppDataFile changed = AppDataFile::open(fname);
+  BOOST_CHECK_EQUAL(changed.view(), "new contents\n");
+  BOOST_CHECK_EQUAL(empty.size(), 0U);
+
+  // file replaced with rename keeping modification time and size
+  const std::string tmpName = std::string(fname) + ".tmp";
+  std::ofstream(tmpName.c_str()) << "old contents\n";
+  struct stat st;
+  BOOST_REQUIRE(stat(fname, &st) == 0);
+  const struct timespec times[2] = { st.st_atim, st.st_mtim };
+  BOOST_REQUIRE(utimensat(AT_FDCWD, tmpName.c_str(), times, 0) == 0);
+  BOOST_REQUIRE(rename(tmpName.c_str(), fname) == 0);
+  AppDataFile replaced = AppDataFile::open(fname);
+  BOOST_CHECK_EQUAL(replaced.view(), "old contents\n");
+  BOOST_CHECK_EQUAL(changed.view(), "new contents\n");
+  unlink(fname);
+}
@@ -0,0 +1,502 @@
+//--------------------------------------------------------------------------
+// File and Version Information:
+// 	$Id$
+//
+// Description:
+//	Benchmark suite for AppUtils. Measures parsing of command lines for
+//	synthetic parsers with many options, parsing of options files of
+//	different sizes (also against a std::getline reader), bulk
+//	conversion of AppCmdOptList values, rendering
+//	of usage() and AppDataPath lookups (with and without the process
+//	cache). Results are printed in JSON format
+//	compatible with Google benchmark output so that they can be compared
+//	across releases with the same tools.
+//
+// Author List:
+//      Andy Salnikov
+//
+//------------------------------------------------------------------------
+
+//---------------
+// C++ Headers --
+//---------------
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/function.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/shared_ptr.hpp>
+
+//-------------------------------
+// Collaborating Class Headers --
+//-------------------------------
+#include "AppUtils/AppCmdLine.h"
+#include "AppUtils/AppCmdExceptions.h"
+#include "AppUtils/AppCmdOpt.h"
+#include "AppUtils/AppCmdOptBool.h"
+#include "AppUtils/AppCmdOptFile.h"
+#include "AppUtils/AppCmdOptList.h"
+#include "AppUtils/AppCmdOptSize.h"
+#include "AppUtils/AppCmdParseStats.h"
+#include "AppUtils/AppDataPath.h"
+
+using namespace AppUtils ;
+namespace fs = boost::filesystem;
+
+//-----------------------------------------------------------------------
+// Local Macros, Typedefs, Structures, Unions and Forward Declarations --
+//-----------------------------------------------------------------------
+
+namespace {
+
+// result of one benchmark
+struct Result {
+  std::string name;
+  unsigned long long iterations;
+  double time;        // seconds per iteration
+  double items;       // items per iteration, 0 if not applicable
+  double bytes;       // bytes per iteration, 0 if not applicable
+};
+
+// runs benchmarks and collects their results
+class Runner {
+public:
+
+  Runner(const std::string& filter, double minTime) : m_filter(filter), m_minTime(minTime), m_results() {}
+
+  // returns true if benchmark with this name should run
+  bool enabled(const std::string& name) const {
+    return m_filter.empty() or name.find(m_filter) != std::string::npos;
+  }
+
+  // run function repeatedly until it takes at least minTime, number of
+  // iterations grows geometrically
+  void run(const std::string& name, const boost::function<void()>& func, double items, double bytes) {
+    if (not enabled(name)) return;
+    unsigned long long iter = 1;
+    double elapsed = 0;
+    for (;;) {
+      const double t0 = AppCmdParseStats::now();
+      for (unsigned long long i = 0; i != iter; ++ i) func();
+      elapsed = AppCmdParseStats::now() - t0;
+      if (elapsed >= m_minTime) break;
+      // aim at 1.4 times minimum time, but grow at most 10 times per step
+      double scale = elapsed > 0 ? m_minTime * 1.4 / elapsed : 10;
+      if (scale > 10) scale = 10;
+      if (scale < 2) scale = 2;
+      iter = (unsigned long long)(iter * scale);
+    }
+    Result res = { name, iter, elapsed / iter, items, bytes };
+    m_results.push_back(res);
+    std::cerr << name << ": " << res.time * 1e9 << " ns" << std::endl;
+  }
+
+  // print all results in JSON format
+  void print(std::ostream& out) const {
+    out << "{\n  \"context\": {\n    \"library\": \"AppUtils\",\n"
+        << "    \"format_version\": 1,\n    \"min_time\": " << m_minTime << "\n  },\n"
+        << "  \"benchmarks\": [";
+    for (std::vector<Result>::const_iterator it = m_results.begin(); it != m_results.end(); ++ it) {
+      if (it != m_results.begin()) out << ",";
+      char buf[64];
+      std::snprintf(buf, sizeof buf, "%.3f", it->time * 1e9);
+      out << "\n    {\n      \"name\": \"" << it->name << "\",\n"
+          << "      \"iterations\": " << it->iterations << ",\n"
+          << "      \"real_time\": " << buf << ",\n"
+          << "      \"time_unit\": \"ns\"";
+      if (it->items > 0) {
+        std::snprintf(buf, sizeof buf, "%.6e", it->items / it->time);
+        out << ",\n      \"items_per_second\": " << buf;
+      }
+      if (it->bytes > 0) {
+        std::snprintf(buf, sizeof buf, "%.6e", it->bytes / it->time);
+        out << ",\n      \"bytes_per_second\": " << buf;
+      }
+      out << "\n    }";
+    }
+    out << "\n  ]\n}\n";
+  }
+
+private:
+
+  std::string m_filter;
+  double m_minTime;
+  std::vector<Result> m_results;
+};
+
+// synthetic parser with the given number of options of different types,
+// also makes command line which sets every option
+class Schema {
+public:
+
+  Schema(int nOptions) : m_cmdline("bench"), m_options(), m_words() {
+    for (int i = 0; i != nOptions; ++ i) {
+      const std::string name = "option" + boost::lexical_cast<std::string>(i);
+      const std::string descr = "Option number " + boost::lexical_cast<std::string>(i)
+          + " of the synthetic parser used for benchmarking, description is long enough to be wrapped.";
+      boost::shared_ptr<AppCmdOptBase> opt;
+      std::string value;
+      switch (i % 5) {
+      case 0:
+        opt.reset(new AppCmdOpt<int>(name, "number", descr, 0));
+        value = boost::lexical_cast<std::string>(i * 7);
+        break;
+      case 1:
+        opt.reset(new AppCmdOpt<double>(name, "number", descr, 0.));
+        value = boost::lexical_cast<std::string>(i * 0.125);
+        break;
+      case 2:
+        opt.reset(new AppCmdOpt<std::string>(name, "string", descr, ""));
+        value = "value-" + name;
+        break;
+      case 3:
+        opt.reset(new AppCmdOptBool(name, descr));
+        break;
+      case 4:
+        opt.reset(new AppCmdOptList<int>(name, "list", descr));
+        value = "1,2,3,4,5,6,7,8";
+        break;
+      }
+      m_cmdline.addOption(*opt);
+      m_options.push_back(opt);
+      m_words.push_back("--" + name);
+      if (not value.empty()) m_words.back() += "=" + value;
+    }
+    m_optFile.reset(new AppCmdOptList<std::string>("options-file", "path", "options file"));
+    m_cmdline.addOption(*m_optFile);
+    m_cmdline.setOptionsFile(*m_optFile);
+    m_cmdline.compile();
+  }
+
+  AppCmdLine& cmdline() { return m_cmdline; }
+
+  const std::vector<std::string>& words() const { return m_words; }
+
+  // option names and values for options file
+  std::string fileLine(int i) const {
+    const std::string& word = m_words[i % m_words.size()];
+    std::string::size_type eq = word.find('=');
+    if (eq == std::string::npos) return word.substr(2) + "\n";
+    return word.substr(2, eq - 2) + " = " + word.substr(eq + 1) + "\n";
+  }
+
+  void parse(const std::vector<std::string>& words) {
+    m_cmdline.parse(words.begin(), words.end());
+  }
+
+  void parseResult(const std::vector<std::string>& words) {
+    AppCmdParseResult result;
+    m_cmdline.parse(words.begin(), words.end(), result);
+  }
+
+  void usage() {
+    std::ostringstream str;
+    m_cmdline.usage(str);
+  }
+
+private:
+
+  AppCmdLine m_cmdline;
+  std::vector<boost::shared_ptr<AppCmdOptBase> > m_options;
+  boost::shared_ptr<AppCmdOptList<std::string> > m_optFile;
+  std::vector<std::string> m_words;
+};
+
+// parse command line with a single list option
+template <typename T>
+void
+parseList(const std::vector<std::string>& words)
+{
+  AppCmdLine cmdline("bench");
+  AppCmdOptList<T> opt(cmdline, "l,list", "list", "list of values");
+  cmdline.parse(words.begin(), words.end());
+}
+
+void
+findData(const std::string& relPath)
+{
+  AppDataPath path(relPath);
+}
+
+// same as above but without help from the process cache
+void
+findDataUncached(const std::string& relPath)
+{
+  AppDataPath::clearCache();
+  AppDataPath path(relPath);
+}
+
+// parser with many options
+void
+benchParse(Runner& runner)
+{
+  const int nOptions[] = { 10, 100, 1000, 5000 };
+  for (unsigned i = 0; i != sizeof nOptions / sizeof nOptions[0]; ++ i) {
+    const std::string suffix = "/options:" + boost::lexical_cast<std::string>(nOptions[i]);
+    if (not runner.enabled("BM_Parse" + suffix) and not runner.enabled("BM_ParseResult" + suffix)) continue;
+    Schema schema(nOptions[i]);
+    runner.run("BM_Parse" + suffix, boost::bind(&Schema::parse, &schema, boost::cref(schema.words())),
+        nOptions[i], 0);
+    runner.run("BM_ParseResult" + suffix, boost::bind(&Schema::parseResult, &schema, boost::cref(schema.words())),
+        nOptions[i], 0);
+  }
+}
+
+// write options file for schema, stops at given size or number of lines,
+// returns false if file cannot be created
+bool
+writeOptionsFile(const Schema& schema, unsigned long long maxBytes, unsigned long long maxLines,
+    std::string& path, unsigned long long& size, unsigned long long& nLines)
+{
+  char fname[] = "/tmp/AppUtilsBench-XXXXXX";
+  int fd = mkstemp(fname);
+  if (fd < 0) {
+    std::perror("mkstemp");
+    return false;
+  }
+  close(fd);
+  path = fname;
+
+  size = 0;
+  nLines = 0;
+  std::ofstream out(fname);
+  while (size < maxBytes and nLines < maxLines) {
+    const std::string line = schema.fileLine(nLines);
+    out << line;
+    size += line.size();
+    ++ nLines;
+  }
+  return true;
+}
+
+// read and split options file with memory-mapped reader
+void
+splitMmap(const std::string& path)
+{
+  AppCmdOptFile file(path);
+}
+
+// read and split options file with std::getline, the same way as options
+// files were read before memory-mapped reader
+void
+splitGetline(const std::string& path)
+{
+  std::ifstream istream(path.c_str());
+  std::vector<std::pair<std::string, std::string> > entries;
+  std::string line;
+  while (std::getline(istream, line)) {
+
+    // skip empty lines and comments
+    const std::string::size_type fchar = line.find_first_not_of(" \t");
+    if (fchar == std::string::npos or line[fchar] == '#') continue;
+
+    // name is everything up to blank or '=', value is everything after '='
+    const std::string::size_type optend = line.find_first_of(" \t=", fchar);
+    std::string optname(line, fchar, optend == std::string::npos ? std::string::npos : optend - fchar);
+    std::string optval;
+    if (optend != std::string::npos) {
+      const std::string::size_type eqpos = line.find('=', optend);
+      if (eqpos != std::string::npos) {
+        const std::string::size_type pos1 = line.find_first_not_of(" \t", eqpos + 1);
+        if (pos1 != std::string::npos) {
+          const std::string::size_type pos2 = line.find_last_not_of(" \t");
+          optval = line.substr(pos1, pos2 - pos1 + 1);
+        }
+      }
+    }
+    entries.push_back(std::make_pair(optname, optval));
+  }
+}
+
+// parse options file with the schema
+void
+runOptionsFile(Runner& runner, const std::string& name, Schema& schema,
+    unsigned long long maxBytes, unsigned long long maxLines)
+{
+  std::string path;
+  unsigned long long size, nLines;
+  if (not writeOptionsFile(schema, maxBytes, maxLines, path, size, nLines)) return;
+
+  std::vector<std::string> words;
+  words.push_back("--options-file");
+  words.push_back(path);
+  runner.run(name, boost::bind(&Schema::parse, &schema, boost::cref(words)), nLines, size);
+
+  unlink(path.c_str());
+}
+
+// options files of different sizes
+void
+benchOptionsFile(Runner& runner, unsigned long long maxSize)
+{
+  const unsigned long long sizes[] = { 1ULL << 10, 1ULL << 20, 100ULL << 20 };
+  for (unsigned i = 0; i != sizeof sizes / sizeof sizes[0]; ++ i) {
+    if (sizes[i] > maxSize) continue;
+    const std::string name = "BM_OptionsFile/bytes:" + boost::lexical_cast<std::string>(sizes[i]);
+    if (not runner.enabled(name)) continue;
+    Schema schema(100);
+    runOptionsFile(runner, name, schema, sizes[i], ~0ULL);
+  }
+
+  // many lines for a larger parser, this is the case used to compare
+  // memory-mapped reader with the older getline reader
+  const unsigned long long nLines = 500000;
+  const int nOptions = 200;
+  const std::string suffix = "/lines:" + boost::lexical_cast<std::string>(nLines);
+  const std::string name = "BM_OptionsFile" + suffix + "/options:" + boost::lexical_cast<std::string>(nOptions);
+  if (maxSize < (32ULL << 20)) return;
+  if (not runner.enabled(name) and not runner.enabled("BM_OptionsFile/mmap" + suffix)
+      and not runner.enabled("BM_OptionsFile/getline" + suffix)) return;
+
+  Schema schema(nOptions);
+  std::string path;
+  unsigned long long size, lines;
+  if (not writeOptionsFile(schema, ~0ULL, nLines, path, size, lines)) return;
+
+  std::vector<std::string> words;
+  words.push_back("--options-file");
+  words.push_back(path);
+  runner.run(name, boost::bind(&Schema::parse, &schema, boost::cref(words)), lines, size);
+
+  // reading and splitting only, memory-mapped reader and the getline reader
+  runner.run("BM_OptionsFile/mmap" + suffix, boost::bind(&splitMmap, boost::cref(path)), lines, size);
+  runner.run("BM_OptionsFile/getline" + suffix, boost::bind(&splitGetline, boost::cref(path)), lines, size);
+
+  unlink(path.c_str());
+}
+
+// bulk conversion of list options
+void
+benchOptList(Runner& runner)
+{
+  const unsigned nItems = 1000000;
+  const std::string suffix = "/items:" + boost::lexical_cast<std::string>(nItems);
+  if (not runner.enabled("BM_OptList<int>" + suffix) and not runner.enabled("BM_OptList<double>" + suffix)) return;
+
+  std::string ilist, dlist;
+  char buf[64];
+  std::srand(12345);
+  for (unsigned i = 0; i != nItems; ++ i) {
+    if (i) {
+      ilist += ',';
+      dlist += ',';
+    }
+    std::snprintf(buf, sizeof buf, "%d", std::rand() % 10000000);
+    ilist += buf;
+    std::snprintf(buf, sizeof buf, "%.*g", 3 + std::rand() % 13, (std::rand() - RAND_MAX/2) / 1000.);
+    dlist += buf;
+  }
+
+  std::vector<std::string> words(2);
+  words[0] = "-l";
+  words[1] = ilist;
+  runner.run("BM_OptList<int>" + suffix, boost::bind(&parseList<int>, boost::cref(words)), nItems, ilist.size());
+
+  std::vector<std::string> dwords(2);
+  dwords[0] = "-l";
+  dwords[1] = dlist;
+  runner.run("BM_OptList<double>" + suffix, boost::bind(&parseList<double>, boost::cref(dwords)), nItems, dlist.size());
+}
+
+// formatting of usage information
+void
+benchUsage(Runner& runner)
+{
+  const int nOptions[] = { 10, 100, 1000 };
+  for (unsigned i = 0; i != sizeof nOptions / sizeof nOptions[0]; ++ i) {
+    const std::string name = "BM_Usage/options:" + boost::lexical_cast<std::string>(nOptions[i]);
+    if (not runner.enabled(name)) continue;
+    Schema schema(nOptions[i]);
+    runner.run(name, boost::bind(&Schema::usage, &schema), nOptions[i], 0);
+  }
+}
+
+// lookup of files in SIT_DATA with few directories
+void
+benchDataPath(Runner& runner)
+{
+  if (not runner.enabled("BM_AppDataPath")) return;
+
+  const int nRoots = 4;
+  char tmpl[] = "/tmp/AppUtilsBench-XXXXXX";
+  if (not mkdtemp(tmpl)) {
+    std::perror("mkdtemp");
+    return;
+  }
+  const fs::path top(tmpl);
+
+  // file exists only in the last root
+  std::string sitData;
+  for (int i = 0; i != nRoots; ++ i) {
+    const fs::path root = top / ("root" + boost::lexical_cast<std::string>(i));
+    fs::create_directories(root / "Package");
+    if (i == nRoots - 1) std::ofstream((root / "Package" / "file.data").string().c_str());
+    if (i) sitData += ':';
+    sitData += root.string();
+  }
+
+  const char* oldSitData = std::getenv("SIT_DATA");
+  const std::string saved = oldSitData ? oldSitData : "";
+  setenv("SIT_DATA", sitData.c_str(), 1);
+
+  runner.run("BM_AppDataPath/found/uncached", boost::bind(&findDataUncached, std::string("Package/file.data")), 1, 0);
+  runner.run("BM_AppDataPath/missing/uncached", boost::bind(&findDataUncached, std::string("Package/missing.data")), 1, 0);
+  runner.run("BM_AppDataPath/found/cached", boost::bind(&findData, std::string("Package/file.data")), 1, 0);
+  runner.run("BM_AppDataPath/missing/cached", boost::bind(&findData, std::string("Package/missing.data")), 1, 0);
+
+  if (oldSitData) {
+    setenv("SIT_DATA", saved.c_str(), 1);
+  } else {
+    unsetenv("SIT_DATA");
+  }
+  fs::remove_all(top);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  AppCmdLine cmdline(argv[0]);
+  AppCmdOpt<std::string> optFilter(cmdline, "f,filter", "string", "run only benchmarks with names containing this string", "");
+  AppCmdOpt<double> optMinTime(cmdline, "t,min-time", "seconds", "minimum time for each benchmark", 0.5);
+  AppCmdOptSize optMaxSize(cmdline, "M,max-file-size", "size", "maximum size of options file, e.g. 10M", 100ULL << 20);
+  AppCmdOpt<std::string> optOutput(cmdline, "o,output", "path", "write JSON results to file instead of standard output", "");
+
+  try {
+    cmdline.parse(argc, argv);
+  } catch (const AppCmdException& exc) {
+    std::cerr << "Error parsing command line: " << exc.what() << "\n";
+    cmdline.usage(std::cerr);
+    return 2;
+  }
+  if (cmdline.helpWanted()) {
+    cmdline.usage(std::cout);
+    return 0;
+  }
+
+  Runner runner(optFilter.value(), optMinTime.value());
+  benchParse(runner);
+  benchOptionsFile(runner, optMaxSize.value());
+  benchOptList(runner);
+  benchUsage(runner);
+  benchDataPath(runner);
+
+  if (optOutput.value().empty()) {
+    runner.print(std::cout);
+  } else {
+    std::ofstream out(optOutput.value().c_str());
+    runner.print(out);
+    if (not out) {
+      std::cerr << "Failed to write " << optOutput.value() << "\n";
+      return 1;
+    }
+  }
+  return 0;
+}